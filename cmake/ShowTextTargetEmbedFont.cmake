@@ -0,0 +1,63 @@
+##****************************************************************************
+## Copyright © 2026 Jan Erik Breimo. All rights reserved.
+## Created by Jan Erik Breimo on 2026-10-19.
+##
+## This file is distributed under the BSD License.
+## License text is included with the source distribution.
+##****************************************************************************
+
+# showtext_target_embed_font(<target>
+#                            FONT <font file>
+#                            SIZE <pixels>
+#                            [NAME <variable name>]
+#                            [CHARSET <characters>]
+#                            [RANGES <first-last> ...])
+#
+# Bakes a bitmap font with ShowTextBake at build time and makes the
+# generated header <NAME>.hpp available to <target>. The header defines
+# the EmbeddedFont <NAME>. The default NAME is DefaultFont and the
+# default character set is 32-126.
+
+set(SHOWTEXT_EMBED_FONT_INCLUDE_DIR "${CMAKE_CURRENT_LIST_DIR}/../src/ShowText")
+
+function(showtext_target_embed_font target)
+    cmake_parse_arguments(ARG "" "FONT;SIZE;NAME;CHARSET" "RANGES" ${ARGN})
+
+    if (NOT ARG_FONT OR NOT ARG_SIZE)
+        message(FATAL_ERROR "showtext_target_embed_font: FONT and SIZE are required.")
+    endif ()
+
+    if (NOT ARG_NAME)
+        set(ARG_NAME DefaultFont)
+    endif ()
+
+    get_filename_component(FONT_PATH "${ARG_FONT}" ABSOLUTE
+        BASE_DIR "${CMAKE_CURRENT_SOURCE_DIR}")
+
+    set(BAKE_ARGS --name ${ARG_NAME})
+    if (ARG_CHARSET)
+        list(APPEND BAKE_ARGS --chars "${ARG_CHARSET}")
+    endif ()
+    foreach (RANGE IN LISTS ARG_RANGES)
+        list(APPEND BAKE_ARGS --range ${RANGE})
+    endforeach ()
+
+    set(OUTPUT_DIR "${CMAKE_CURRENT_BINARY_DIR}/${target}_embedded_fonts")
+    set(OUTPUT_FILE "${OUTPUT_DIR}/${ARG_NAME}.hpp")
+
+    add_custom_command(
+        OUTPUT "${OUTPUT_FILE}"
+        COMMAND ${CMAKE_COMMAND} -E make_directory "${OUTPUT_DIR}"
+        COMMAND ShowTextBake "${FONT_PATH}" ${ARG_SIZE} "${OUTPUT_FILE}" ${BAKE_ARGS}
+        DEPENDS ShowTextBake "${FONT_PATH}"
+        COMMENT "Baking ${ARG_FONT} (${ARG_SIZE} px) into ${ARG_NAME}.hpp"
+        VERBATIM
+    )
+
+    target_sources(${target} PRIVATE "${OUTPUT_FILE}")
+    target_include_directories(${target}
+        PRIVATE
+            "${OUTPUT_DIR}"
+            "${SHOWTEXT_EMBED_FONT_INCLUDE_DIR}"
+        )
+endfunction()
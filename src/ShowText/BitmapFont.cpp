@@ -7,6 +7,7 @@
 //****************************************************************************
 #include "BitmapFont.hpp"
 
+#include <algorithm>
 #include <filesystem>
 #include <Yimage/Yimage.hpp>
 #include <Yson/JsonReader.hpp>
@@ -14,12 +15,17 @@
 #include <Yson/ReaderIterators.hpp>
 #include <Ystring/Ystring.hpp>
 
+#include "FontCoverage.hpp"
 #include "FreeTypeWrapper.hpp"
+#include "Trace.hpp"
 
 BitmapFont::BitmapFont(std::unordered_map<char32_t, BitmapCharData> char_data,
-                       Yimage::Image image)
+                       Yimage::Image image,
+                       KerningTable kerning)
     : char_data_(std::move(char_data)),
-      image_(std::move(image))
+      kerning_(std::move(kerning)),
+      image_(std::move(image)),
+      image_size_(image_.width(), image_.height())
 {
 }
 
@@ -35,6 +41,20 @@ const std::unordered_map<char32_t, BitmapCharData>& BitmapFont::all_char_data()
     return char_data_;
 }
 
+int BitmapFont::kerning(char32_t left, char32_t right) const
+{
+    if (kerning_.empty())
+        return 0;
+    if (auto it = kerning_.find(make_kerning_key(left, right)); it != kerning_.end())
+        return it->second;
+    return 0;
+}
+
+const KerningTable& BitmapFont::all_kerning() const
+{
+    return kerning_;
+}
+
 std::pair<int, int> BitmapFont::vertical_extremes() const
 {
     int max_hi = 0, min_lo = 0;
@@ -55,6 +75,11 @@ const Yimage::Image& BitmapFont::image() const
     return image_;
 }
 
+std::pair<unsigned, unsigned> BitmapFont::image_size() const
+{
+    return image_size_;
+}
+
 Yimage::Image BitmapFont::release_image()
 {
     return std::move(image_);
@@ -104,21 +129,22 @@ namespace
             .advance = int(glyph->advance.x)};
     }
 
-    std::pair<unsigned, unsigned> get_size(freetype::Face& face, char32_t ch)
+    template <typename LoadFunc>
+    std::pair<unsigned, unsigned> get_size(char32_t key, LoadFunc load)
     {
-        face.load_char(ch, FT_LOAD_BITMAP_METRICS_ONLY);
-        auto glyph = face->glyph;
+        auto glyph = load(key, FT_LOAD_BITMAP_METRICS_ONLY);
         auto bmp = glyph->bitmap;
         return {bmp.width, bmp.rows};
     }
 
+    template <typename LoadFunc>
     std::pair<unsigned, unsigned>
-    get_max_glyph_size(freetype::Face& face, std::span<char32_t> chars)
+    get_max_glyph_size(std::span<const char32_t> keys, LoadFunc load)
     {
         unsigned max_width = 0, max_height = 0;
-        for (const auto ch: chars)
+        for (const auto key: keys)
         {
-            auto[width, height] = get_size(face, ch);
+            auto[width, height] = get_size(key, load);
             if (width > max_width)
                 max_width = width;
             if (height > max_height)
@@ -126,46 +152,229 @@ namespace
         }
         return {max_width, max_height};
     }
+
+    // load(key, flags) loads the glyph for key and returns the glyph slot
+    // it was loaded into.
+    template <typename LoadFunc>
+    BitmapFont make_bitmap_font(std::span<const char32_t> keys, LoadFunc load,
+                                KerningTable kerning = {})
+    {
+        trace::Span metrics_span("get_max_glyph_size");
+        auto[glyph_width, glyph_height] = get_max_glyph_size(keys, load);
+        metrics_span.end();
+        glyph_width += 1;
+        glyph_height += 1;
+        trace::Span grid_span("get_best_grid_size");
+        const auto[grid_width, grid_height] = get_best_grid_size(keys.size());
+        grid_span.end();
+        SHOWTEXT_TRACE_SCOPE("render_glyphs");
+        auto image_width = glyph_width * grid_width;
+        if (auto n = image_width % 8)
+            image_width += 8 - n;
+        std::unordered_map<char32_t, BitmapCharData> char_map;
+        Yimage::Image image(Yimage::PixelType::MONO_8,
+                            image_width,
+                            glyph_height * grid_height);
+        Yimage::MutableImageView mut_image = image;
+        for (unsigned i = 0; i < keys.size(); ++i)
+        {
+            const auto x = (i % grid_width) * glyph_width;
+            const auto y = (i / grid_width) * glyph_height;
+
+            const auto key = keys[i];
+            auto glyph = load(key, FT_LOAD_RENDER);
+            const auto& data = char_map.insert({key,
+                                                make_char_data(glyph, x, y)}).first->second;
+            Yimage::ImageView glyph_img(glyph->bitmap.buffer,
+                                        Yimage::PixelType::MONO_8,
+                                        data.width,
+                                        data.height);
+            paste(glyph_img, mut_image, x, y);
+        }
+
+        return {std::move(char_map), std::move(image), std::move(kerning)};
+    }
+
+    // Only the kerning in the font's kern table is available through
+    // FreeType, GPOS pair adjustments require a shaper. The pairs are
+    // read from the table so the cost is proportional to the number of
+    // pairs rather than the square of the number of characters.
+    void add_kerning(KerningTable& kerning,
+                     freetype::Face& face,
+                     std::span<const char32_t> chars)
+    {
+        if (!FT_HAS_KERNING(face.get()))
+            return;
+
+        std::unordered_multimap<FT_UInt, char32_t> glyph_chars;
+        for (const auto ch : chars)
+        {
+            if (auto index = FT_Get_Char_Index(face.get(), ch))
+                glyph_chars.insert({index, ch});
+        }
+
+        for (const auto& [left_index, right_index] : face.get_kerning_pairs())
+        {
+            auto [left_begin, left_end] = glyph_chars.equal_range(left_index);
+            if (left_begin == left_end)
+                continue;
+            auto [right_begin, right_end] = glyph_chars.equal_range(right_index);
+            if (right_begin == right_end)
+                continue;
+
+            auto delta = face.get_kerning(left_index, right_index);
+            if (delta.x == 0)
+                continue;
+
+            for (auto left = left_begin; left != left_end; ++left)
+            {
+                for (auto right = right_begin; right != right_end; ++right)
+                {
+                    kerning.insert({make_kerning_key(left->second, right->second),
+                                    int(delta.x)});
+                }
+            }
+        }
+    }
+
+    // find_face(ch) returns the index in faces of the face that has
+    // ch, or FallbackIndex::NO_FACE.
+    template <typename FindFaceFunc>
+    BitmapFont make_fallback_bitmap_font(std::span<freetype::Face* const> faces,
+                                         FindFaceFunc find_face,
+                                         unsigned font_size,
+                                         std::span<char32_t> chars)
+    {
+        SHOWTEXT_TRACE_SCOPE("make_bitmap_font");
+        for (auto face : faces)
+        {
+            face->select_charmap(FT_ENCODING_UNICODE);
+            face->set_pixel_sizes(0, font_size);
+        }
+
+        std::vector<char32_t> covered_chars;
+        for (const auto ch : chars)
+        {
+            if (find_face(ch) != FallbackIndex::NO_FACE)
+                covered_chars.push_back(ch);
+        }
+
+        trace::Span kerning_span("add_kerning");
+        KerningTable kerning;
+        for (size_t i = 0; i < faces.size(); ++i)
+        {
+            std::vector<char32_t> face_chars;
+            for (const auto ch : covered_chars)
+            {
+                if (find_face(ch) == int(i))
+                    face_chars.push_back(ch);
+            }
+            add_kerning(kerning, *faces[i], face_chars);
+        }
+        kerning_span.end();
+
+        return make_bitmap_font(covered_chars,
+                                [&](char32_t ch, FT_Int32 flags)
+                                {
+                                    auto& face = *faces[find_face(ch)];
+                                    face.load_char(ch, flags);
+                                    return face->glyph;
+                                },
+                                std::move(kerning));
+    }
 }
 
 BitmapFont make_bitmap_font(const std::string& font_path,
                             unsigned font_size,
                             std::span<char32_t> chars)
+{
+    return make_bitmap_font(std::span(&font_path, 1), font_size, chars);
+}
+
+BitmapFont make_bitmap_font(std::span<const std::string> font_paths,
+                            unsigned font_size,
+                            std::span<char32_t> chars)
 {
     freetype::Library library;
-    auto face = library.new_face(font_path);
-    face.select_charmap(FT_ENCODING_UNICODE);
-    face.set_pixel_sizes(0, font_size);
-    auto[glyph_width, glyph_height] = get_max_glyph_size(face, chars);
-    glyph_width += 1;
-    glyph_height += 1;
-    const auto[grid_width, grid_height] = get_best_grid_size(chars.size());
-    auto image_width = glyph_width * grid_width;
-    if (auto n = image_width % 8)
-        image_width += 8 - n;
-    std::unordered_map<char32_t, BitmapCharData> char_map;
-    Yimage::Image image(Yimage::PixelType::MONO_8,
-                        image_width,
-                        glyph_height * grid_height);
-    Yimage::MutableImageView mut_image = image;
-    for (unsigned i = 0; i < chars.size(); ++i)
+    std::vector<freetype::Face> faces;
+    for (const auto& font_path : font_paths)
     {
-        const auto x = (i % grid_width) * glyph_width;
-        const auto y = (i / grid_width) * glyph_height;
-
-        const auto ch = chars[i];
-        face.load_char(ch, FT_LOAD_RENDER);
-        auto glyph = face->glyph;
-        const auto& data = char_map.insert({ch,
-                                            make_char_data(glyph, x, y)}).first->second;
-        Yimage::ImageView glyph_img(glyph->bitmap.buffer,
-                                    Yimage::PixelType::MONO_8,
-                                    data.width,
-                                    data.height);
-        paste(glyph_img, mut_image, x, y);
+        auto& face = faces.emplace_back(library.new_face(font_path));
+        face.select_charmap(FT_ENCODING_UNICODE);
     }
 
-    return {std::move(char_map), std::move(image)};
+    std::vector<freetype::Face*> face_ptrs;
+    for (auto& face : faces)
+        face_ptrs.push_back(&face);
+
+    // A single face's charmap is all that is needed, there is no point
+    // in walking it to build a coverage bitmap.
+    if (faces.size() == 1)
+    {
+        return make_fallback_bitmap_font(
+            face_ptrs,
+            [&](char32_t ch)
+            {
+                return FT_Get_Char_Index(faces[0].get(), ch) != 0
+                       ? 0 : FallbackIndex::NO_FACE;
+            },
+            font_size, chars);
+    }
+
+    trace::Span coverage_span("get_coverage");
+    std::vector<CoverageBitmap> coverage;
+    for (const auto& face : faces)
+        coverage.push_back(get_coverage(face));
+    coverage_span.end();
+
+    std::vector<const CoverageBitmap*> coverage_ptrs;
+    for (const auto& face_coverage : coverage)
+        coverage_ptrs.push_back(&face_coverage);
+    return make_bitmap_font(face_ptrs, coverage_ptrs, font_size, chars);
+}
+
+BitmapFont make_bitmap_font(std::span<freetype::Face* const> faces,
+                            std::span<const CoverageBitmap* const> coverage,
+                            unsigned font_size,
+                            std::span<char32_t> chars)
+{
+    if (faces.size() != coverage.size())
+        throw std::runtime_error("There must be one coverage bitmap per face.");
+
+    if (faces.size() == 1)
+    {
+        return make_fallback_bitmap_font(
+            faces,
+            [&](char32_t ch)
+            {
+                return coverage[0]->contains(ch) ? 0 : FallbackIndex::NO_FACE;
+            },
+            font_size, chars);
+    }
+
+    trace::Span index_span("FallbackIndex");
+    const FallbackIndex index(coverage);
+    index_span.end();
+    return make_fallback_bitmap_font(
+        faces,
+        [&](char32_t ch) {return index.find_face(ch);},
+        font_size, chars);
+}
+
+BitmapFont make_glyph_bitmap_font(const std::string& font_path,
+                                  unsigned font_size,
+                                  std::span<const char32_t> glyph_indexes)
+{
+    SHOWTEXT_TRACE_SCOPE("make_glyph_bitmap_font");
+    freetype::Library library;
+    auto face = library.new_face(font_path);
+    face.set_pixel_sizes(0, font_size);
+    return make_bitmap_font(glyph_indexes,
+                            [&](char32_t index, FT_Int32 flags)
+                            {
+                                face.load_glyph(index, flags);
+                                return face->glyph;
+                            });
 }
 
 namespace
@@ -193,12 +402,38 @@ namespace
     }
 }
 
-std::unordered_map<char32_t, BitmapCharData> read_font(Yson::Reader& reader)
+namespace
+{
+    // The key of each pair is the UTF-8 encoded left and right character.
+    KerningTable read_kerning(Yson::Reader& reader)
+    {
+        KerningTable result;
+        for (const auto& key: keys(reader))
+        {
+            auto chars = ystring::to_utf32(key);
+            if (chars.size() != 2)
+                throw std::runtime_error("Invalid kerning pair: " + key);
+            result.insert({make_kerning_key(chars[0], chars[1]),
+                           Yson::get<int>(reader.readItem())});
+        }
+        return result;
+    }
+}
+
+std::unordered_map<char32_t, BitmapCharData> read_font(Yson::Reader& reader,
+                                                       KerningTable& kerning)
 {
     using Yson::get;
     std::unordered_map<char32_t, BitmapCharData> result;
     for (const auto& key: keys(reader))
     {
+        // Character keys are a single code point and can't be confused
+        // with "kerning".
+        if (key == "kerning")
+        {
+            kerning = read_kerning(reader);
+            continue;
+        }
         auto item = reader.readItem();
         auto position = item["position"];
         auto size = item["size"];
@@ -218,9 +453,17 @@ std::unordered_map<char32_t, BitmapCharData> read_font(Yson::Reader& reader)
 
 BitmapFont read_bitmap_font(const std::string& font_path)
 {
+    SHOWTEXT_TRACE_SCOPE("read_bitmap_font");
     auto[json_path, png_path] = get_json_and_png_paths(font_path);
+    trace::Span json_span("read_font");
     Yson::JsonReader reader(json_path);
-    return {read_font(reader), Yimage::read_png(png_path)};
+    KerningTable kerning;
+    auto char_data = read_font(reader, kerning);
+    json_span.end();
+    trace::Span png_span("read_png");
+    auto image = Yimage::read_png(png_path);
+    png_span.end();
+    return {std::move(char_data), std::move(image), std::move(kerning)};
 }
 
 namespace
@@ -245,6 +488,7 @@ namespace
 }
 
 void write_font(const std::unordered_map<char32_t, BitmapCharData>& font,
+                const KerningTable& kerning,
                 Yson::Writer& writer)
 {
     writer.beginObject();
@@ -253,13 +497,29 @@ void write_font(const std::unordered_map<char32_t, BitmapCharData>& font,
         writer.key(ystring::from_utf32(ch));
         write(writer, data);
     }
+
+    if (!kerning.empty())
+    {
+        std::vector<std::pair<uint64_t, int>> pairs(kerning.begin(),
+                                                    kerning.end());
+        std::sort(pairs.begin(), pairs.end());
+        writer.key("kerning").beginObject();
+        for (auto [key, value] : pairs)
+        {
+            writer.key(ystring::from_utf32(char32_t(key >> 32u))
+                       + ystring::from_utf32(char32_t(key & 0xFFFFFFFFu)));
+            writer.value(value);
+        }
+        writer.endObject();
+    }
     writer.endObject();
 }
 
 void write_font(const BitmapFont& font, const std::string& file_name)
 {
+    SHOWTEXT_TRACE_SCOPE("write_font");
     Yson::JsonWriter writer(file_name + ".json",
                             Yson::JsonFormatting::FORMAT);
-    write_font(font.all_char_data(), writer);
+    write_font(font.all_char_data(), font.all_kerning(), writer);
     Yimage::write_png(file_name + ".png", font.image());
 }
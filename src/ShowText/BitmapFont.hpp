@@ -7,11 +7,13 @@
 //****************************************************************************
 #pragma once
 
+#include <cstdint>
 #include <span>
 #include <unordered_map>
 #include <Yimage/Image.hpp>
 #include <Yson/Reader.hpp>
 #include <Yson/Writer.hpp>
+#include "FontCoverage.hpp"
 
 struct BitmapCharData
 {
@@ -24,13 +26,25 @@ struct BitmapCharData
     int advance = 0;
 };
 
+/**
+ * @brief Maps pairs of characters, see make_kerning_key, to kerning
+ *  adjustments in FreeType's 26.6 fixed point format.
+ */
+using KerningTable = std::unordered_map<uint64_t, int>;
+
+constexpr uint64_t make_kerning_key(char32_t left, char32_t right)
+{
+    return (uint64_t(left) << 32u) | uint64_t(right);
+}
+
 class BitmapFont
 {
 public:
     BitmapFont() = default;
 
     BitmapFont(std::unordered_map<char32_t, BitmapCharData> char_data,
-               Yimage::Image image);
+               Yimage::Image image,
+               KerningTable kerning = {});
 
     [[nodiscard]]
     const BitmapCharData* char_data(char32_t ch) const;
@@ -38,23 +52,73 @@ public:
     [[nodiscard]]
     const std::unordered_map<char32_t, BitmapCharData>& all_char_data() const;
 
+    /**
+     * @brief Returns the adjustment of the distance between @a left and
+     *  @a right in 26.6 fixed point format.
+     */
+    [[nodiscard]]
+    int kerning(char32_t left, char32_t right) const;
+
+    [[nodiscard]]
+    const KerningTable& all_kerning() const;
+
     [[nodiscard]]
     std::pair<int, int> vertical_extremes() const;
 
     [[nodiscard]]
     const Yimage::Image& image() const;
 
+    /**
+     * @brief The width and height of the image, also after it has been
+     *  released.
+     */
+    [[nodiscard]]
+    std::pair<unsigned, unsigned> image_size() const;
+
     Yimage::Image release_image();
 
 private:
     std::unordered_map<char32_t, BitmapCharData> char_data_;
+    KerningTable kerning_;
     Yimage::Image image_;
+    std::pair<unsigned, unsigned> image_size_;
 };
 
 BitmapFont make_bitmap_font(const std::string& font_path,
                             unsigned font_size,
                             std::span<char32_t> chars);
 
+/**
+ * @brief Creates a bitmap font with glyphs from a chain of fonts.
+ *
+ * Each character is taken from the first font in @a font_paths that has
+ * it, characters none of the fonts have are left out. The font's kerning
+ * pairs are included for characters taken from the same font.
+ */
+BitmapFont make_bitmap_font(std::span<const std::string> font_paths,
+                            unsigned font_size,
+                            std::span<char32_t> chars);
+
+/**
+ * @brief Creates a bitmap font with glyphs from a chain of faces that
+ *  are already open.
+ *
+ * @a coverage must have been made with get_coverage for each of the
+ * faces. The faces' charmaps and pixel sizes are changed.
+ */
+BitmapFont make_bitmap_font(std::span<freetype::Face* const> faces,
+                            std::span<const CoverageBitmap* const> coverage,
+                            unsigned font_size,
+                            std::span<char32_t> chars);
+
+/**
+ * @brief Creates a bitmap font where the keys are glyph indexes rather
+ *  than code points, for text that has been shaped.
+ */
+BitmapFont make_glyph_bitmap_font(const std::string& font_path,
+                                  unsigned font_size,
+                                  std::span<const char32_t> glyph_indexes);
+
 BitmapFont read_bitmap_font(const std::string& font_path);
 
 void write_font(const BitmapFont& font, const std::string& file_name);
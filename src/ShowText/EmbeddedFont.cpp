@@ -0,0 +1,125 @@
+//****************************************************************************
+// Copyright © 2026 Jan Erik Breimo. All rights reserved.
+// Created by Jan Erik Breimo on 2026-10-19.
+//
+// This file is distributed under the BSD License.
+// License text is included with the source distribution.
+//****************************************************************************
+#include "EmbeddedFont.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <vector>
+#include <Yimage/Yimage.hpp>
+#include "Trace.hpp"
+
+BitmapFont make_bitmap_font(const EmbeddedFont& font)
+{
+    SHOWTEXT_TRACE_SCOPE("make_bitmap_font");
+    if (font.image.size() != size_t(font.image_width) * font.image_height)
+        throw std::runtime_error("Embedded font has an incorrect image size.");
+
+    std::unordered_map<char32_t, BitmapCharData> char_map;
+    char_map.reserve(font.chars.size());
+    for (const auto& [ch, data] : font.chars)
+        char_map.insert({ch, data});
+
+    KerningTable kerning;
+    kerning.reserve(font.kerning.size());
+    for (const auto& [left, right, value] : font.kerning)
+        kerning.insert({make_kerning_key(left, right), value});
+
+    Yimage::Image image(Yimage::PixelType::MONO_8,
+                        font.image_width,
+                        font.image_height);
+    Yimage::MutableImageView mut_image = image;
+    Yimage::ImageView src_image(font.image.data(),
+                                Yimage::PixelType::MONO_8,
+                                font.image_width,
+                                font.image_height);
+    paste(src_image, mut_image, 0, 0);
+    return {std::move(char_map), std::move(image), std::move(kerning)};
+}
+
+void write_embedded_font(const BitmapFont& font,
+                         const std::string& name,
+                         std::ostream& stream)
+{
+    SHOWTEXT_TRACE_SCOPE("write_embedded_font");
+    const auto& image = font.image();
+    if (image.pixel_type() != Yimage::PixelType::MONO_8)
+        throw std::runtime_error("Only MONO_8 fonts can be embedded.");
+
+    if (font.all_char_data().empty())
+        throw std::runtime_error("Can't embed a font without characters.");
+
+    std::vector<std::pair<char32_t, BitmapCharData>> chars(
+        font.all_char_data().begin(), font.all_char_data().end());
+    std::sort(chars.begin(), chars.end(),
+              [](auto& a, auto& b) {return a.first < b.first;});
+
+    stream << "// Generated by ShowTextBake. Do not edit.\n"
+              "#pragma once\n"
+              "#include \"EmbeddedFont.hpp\"\n"
+              "\n"
+              "inline constexpr EmbeddedCharData " << name << "_chars[] = {\n";
+    for (const auto& [ch, d] : chars)
+    {
+        stream << "    {" << uint32_t(ch) << ", {" << d.x << ", " << d.y
+               << ", " << d.width << ", " << d.height
+               << ", " << d.bearing_x << ", " << d.bearing_y
+               << ", " << d.advance << "}},\n";
+    }
+    stream << "};\n"
+              "\n";
+
+    std::vector<std::pair<uint64_t, int>> kerning(font.all_kerning().begin(),
+                                                  font.all_kerning().end());
+    std::sort(kerning.begin(), kerning.end());
+    if (!kerning.empty())
+    {
+        stream << "inline constexpr EmbeddedKerningPair " << name
+               << "_kerning[] = {\n";
+        for (const auto& [key, value] : kerning)
+        {
+            stream << "    {" << (key >> 32u) << ", " << (key & 0xFFFFFFFFu)
+                   << ", " << value << "},\n";
+        }
+        stream << "};\n"
+                  "\n";
+    }
+
+    stream << "inline constexpr uint8_t " << name << "_image[] = {";
+
+    const auto stride = image.height() ? image.size() / image.height() : 0;
+    size_t count = 0;
+    for (unsigned y = 0; y < image.height(); ++y)
+    {
+        const auto row = image.data() + y * stride;
+        for (unsigned x = 0; x < image.width(); ++x)
+        {
+            stream << (count++ % 16 == 0 ? "\n    " : " ") << unsigned(row[x]) << ',';
+        }
+    }
+    if (count == 0)
+        stream << "0";
+    stream << "\n};\n"
+              "\n"
+              "inline constexpr EmbeddedFont " << name << " = {\n"
+              "    " << name << "_chars,\n"
+              "    " << image.width() << ", " << image.height() << ",\n"
+              "    {" << name << "_image, " << count << "}";
+    if (!kerning.empty())
+        stream << ",\n    " << name << "_kerning";
+    stream << "};\n";
+}
+
+void write_embedded_font(const BitmapFont& font,
+                         const std::string& name,
+                         const std::string& file_name)
+{
+    std::ofstream stream(file_name);
+    if (!stream)
+        throw std::runtime_error("Can't create: " + file_name);
+    write_embedded_font(font, name, stream);
+}
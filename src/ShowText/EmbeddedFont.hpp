@@ -0,0 +1,69 @@
+//****************************************************************************
+// Copyright © 2026 Jan Erik Breimo. All rights reserved.
+// Created by Jan Erik Breimo on 2026-10-19.
+//
+// This file is distributed under the BSD License.
+// License text is included with the source distribution.
+//****************************************************************************
+#pragma once
+#include <cstdint>
+#include <iosfwd>
+#include <span>
+#include "BitmapFont.hpp"
+
+struct EmbeddedCharData
+{
+    char32_t ch = 0;
+    BitmapCharData data;
+};
+
+struct EmbeddedKerningPair
+{
+    char32_t left = 0;
+    char32_t right = 0;
+    int value = 0;
+};
+
+/**
+ * @brief A bitmap font compiled into the executable.
+ *
+ * Instances are generated by ShowTextBake, see
+ * showtext_target_embed_font in cmake/ShowTextTargetEmbedFont.cmake.
+ * @a chars is sorted on the code points and @a image is a MONO_8
+ * image without padding.
+ */
+struct EmbeddedFont
+{
+    std::span<const EmbeddedCharData> chars;
+    unsigned image_width = 0;
+    unsigned image_height = 0;
+    std::span<const uint8_t> image;
+    std::span<const EmbeddedKerningPair> kerning;
+};
+
+constexpr const BitmapCharData*
+find_char_data(const EmbeddedFont& font, char32_t ch)
+{
+    size_t lo = 0, hi = font.chars.size();
+    while (lo < hi)
+    {
+        const auto mid = lo + (hi - lo) / 2;
+        if (font.chars[mid].ch < ch)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo != font.chars.size() && font.chars[lo].ch == ch)
+        return &font.chars[lo].data;
+    return nullptr;
+}
+
+BitmapFont make_bitmap_font(const EmbeddedFont& font);
+
+void write_embedded_font(const BitmapFont& font,
+                         const std::string& name,
+                         std::ostream& stream);
+
+void write_embedded_font(const BitmapFont& font,
+                         const std::string& name,
+                         const std::string& file_name);
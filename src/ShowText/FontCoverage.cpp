@@ -0,0 +1,110 @@
+//****************************************************************************
+// Copyright © 2026 Jan Erik Breimo. All rights reserved.
+// Created by Jan Erik Breimo on 2026-10-19.
+//
+// This file is distributed under the BSD License.
+// License text is included with the source distribution.
+//****************************************************************************
+#include "FontCoverage.hpp"
+
+#include <bit>
+#include <stdexcept>
+
+namespace
+{
+    constexpr char32_t CODE_POINT_COUNT = 0x110000;
+}
+
+CoverageBitmap::CoverageBitmap()
+    : bits_(CODE_POINT_COUNT / 64)
+{}
+
+void CoverageBitmap::add(char32_t ch)
+{
+    if (ch < CODE_POINT_COUNT)
+        bits_[ch / 64] |= uint64_t(1) << (ch % 64);
+}
+
+bool CoverageBitmap::contains(char32_t ch) const
+{
+    return ch < CODE_POINT_COUNT
+           && (bits_[ch / 64] & (uint64_t(1) << (ch % 64))) != 0;
+}
+
+std::span<const uint64_t> CoverageBitmap::words() const
+{
+    return bits_;
+}
+
+CoverageBitmap get_coverage(const freetype::Face& face)
+{
+    // FT_Get_First_Char and FT_Get_Next_Char don't modify the face, but
+    // they take a non-const FT_Face.
+    auto ft_face = const_cast<FT_Face>(face.get());
+    CoverageBitmap result;
+    FT_UInt glyph_index = 0;
+    auto ch = FT_Get_First_Char(ft_face, &glyph_index);
+    while (glyph_index != 0)
+    {
+        result.add(char32_t(ch));
+        ch = FT_Get_Next_Char(ft_face, ch, &glyph_index);
+    }
+    return result;
+}
+
+FallbackIndex::FallbackIndex()
+    : page_index_(CODE_POINT_COUNT / PAGE_SIZE),
+      pages_(1)
+{
+    pages_[0].fill(EMPTY);
+}
+
+FallbackIndex::FallbackIndex(std::span<const CoverageBitmap* const> faces)
+    : FallbackIndex()
+{
+    if (faces.size() >= EMPTY)
+        throw std::runtime_error("Too many fallback faces.");
+
+    constexpr size_t WORDS_PER_PAGE = PAGE_SIZE / 64;
+    for (size_t i = 0; i < page_index_.size(); ++i)
+    {
+        Page page;
+        bool empty = true;
+        for (size_t j = 0; j < WORDS_PER_PAGE; ++j)
+        {
+            const auto word = i * WORDS_PER_PAGE + j;
+            // The code points in this word that an earlier face has.
+            uint64_t assigned = 0;
+            for (size_t face = 0; face < faces.size(); ++face)
+            {
+                auto bits = faces[face]->words()[word] & ~assigned;
+                if (bits == 0)
+                    continue;
+
+                if (empty)
+                {
+                    page.fill(EMPTY);
+                    empty = false;
+                }
+
+                assigned |= bits;
+                for (; bits != 0; bits &= bits - 1)
+                    page[j * 64 + size_t(std::countr_zero(bits))] = uint8_t(face);
+            }
+        }
+
+        if (!empty)
+        {
+            page_index_[i] = uint16_t(pages_.size());
+            pages_.push_back(page);
+        }
+    }
+}
+
+int FallbackIndex::find_face(char32_t ch) const
+{
+    if (ch >= CODE_POINT_COUNT)
+        return NO_FACE;
+    const auto face = pages_[page_index_[ch / PAGE_SIZE]][ch % PAGE_SIZE];
+    return face == EMPTY ? NO_FACE : int(face);
+}
@@ -0,0 +1,76 @@
+//****************************************************************************
+// Copyright © 2026 Jan Erik Breimo. All rights reserved.
+// Created by Jan Erik Breimo on 2026-10-19.
+//
+// This file is distributed under the BSD License.
+// License text is included with the source distribution.
+//****************************************************************************
+#pragma once
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "FreeTypeWrapper.hpp"
+
+/**
+ * @brief One bit for every Unicode code point, set if a face has a glyph
+ *  for it.
+ */
+class CoverageBitmap
+{
+public:
+    CoverageBitmap();
+
+    void add(char32_t ch);
+
+    [[nodiscard]]
+    bool contains(char32_t ch) const;
+
+    /**
+     * @brief The bitmap as 64-bit words, bit n of word i is code
+     *  point i * 64 + n.
+     */
+    [[nodiscard]]
+    std::span<const uint64_t> words() const;
+private:
+    std::vector<uint64_t> bits_;
+};
+
+/**
+ * @brief Returns the code points in @a face's current charmap.
+ */
+CoverageBitmap get_coverage(const freetype::Face& face);
+
+/**
+ * @brief Maps code points to the first face in a fallback chain that
+ *  has a glyph for them.
+ *
+ * Lookups are two array accesses regardless of the number of faces.
+ * Building the index only visits the nonzero words of the coverage
+ * bitmaps.
+ */
+class FallbackIndex
+{
+public:
+    static constexpr int NO_FACE = -1;
+
+    FallbackIndex();
+
+    explicit FallbackIndex(std::span<const CoverageBitmap* const> faces);
+
+    /**
+     * @brief Returns the index of the first face that has @a ch, or
+     *  NO_FACE.
+     */
+    [[nodiscard]]
+    int find_face(char32_t ch) const;
+private:
+    static constexpr size_t PAGE_SIZE = 256;
+    static constexpr uint8_t EMPTY = 0xFF;
+
+    using Page = std::array<uint8_t, PAGE_SIZE>;
+
+    // Page 0 is shared by all ranges no face covers.
+    std::vector<uint16_t> page_index_;
+    std::vector<Page> pages_;
+};
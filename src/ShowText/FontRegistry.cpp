@@ -0,0 +1,123 @@
+//****************************************************************************
+// Copyright © 2026 Jan Erik Breimo. All rights reserved.
+// Created by Jan Erik Breimo on 2026-10-19.
+//
+// This file is distributed under the BSD License.
+// License text is included with the source distribution.
+//****************************************************************************
+#include "FontRegistry.hpp"
+
+FontTexture::FontTexture(std::shared_ptr<BitmapFont> font)
+    : font_(std::move(font))
+{
+    if (!font_)
+        throw std::runtime_error("bitmap_font is NULL");
+
+    // An image that has been released can't be uploaded again.
+    const auto [width, height] = font_->image_size();
+    if (width != font_->image().width() || height != font_->image().height())
+        throw std::runtime_error("The bitmap font's image has been released.");
+
+    texture_ = Tungsten::generate_texture();
+    Tungsten::bind_texture(GL_TEXTURE_2D, texture_);
+    Tungsten::set_texture_min_filter(GL_TEXTURE_2D, GL_LINEAR);
+    Tungsten::set_texture_mag_filter(GL_TEXTURE_2D, GL_LINEAR);
+    Tungsten::set_texture_parameter(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    Tungsten::set_texture_parameter(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    const auto& image = font_->image();
+    auto [format, type] = get_ogl_pixel_type(image.pixel_type());
+    Tungsten::set_texture_image_2d(GL_TEXTURE_2D, 0, GL_RED,
+                                   GLsizei(image.width()),
+                                   GLsizei(image.height()),
+                                   format, type,
+                                   nullptr);
+    texture_size_ = size_t(image.width()) * image.height();
+    uploader_.set_texture(GL_TEXTURE_2D, texture_);
+    uploader_.add_image(image);
+}
+
+const std::shared_ptr<BitmapFont>& FontTexture::bitmap_font() const
+{
+    return font_;
+}
+
+GLuint FontTexture::texture() const
+{
+    return texture_;
+}
+
+void FontTexture::bind() const
+{
+    Tungsten::bind_texture(GL_TEXTURE_2D, texture_);
+}
+
+bool FontTexture::update()
+{
+    if (ready_)
+        return true;
+
+    if (uploader_.has_pending_data())
+        uploader_.upload_next_chunk();
+
+    if (uploader_.is_complete())
+    {
+        uploader_.release_buffers();
+        ready_ = true;
+    }
+    return ready_;
+}
+
+bool FontTexture::is_ready() const
+{
+    return ready_;
+}
+
+size_t FontTexture::texture_memory_usage() const
+{
+    return texture_size_;
+}
+
+size_t FontTexture::buffer_memory_usage() const
+{
+    return uploader_.buffer_memory_usage();
+}
+
+std::shared_ptr<BitmapFont>
+FontRegistry::get_bitmap_font(const FontKey& key,
+                              const std::function<BitmapFont()>& load)
+{
+    std::shared_ptr<FontEntry> entry;
+    {
+        std::lock_guard lock(mutex_);
+        auto& e = fonts_[key];
+        if (!e)
+            e = std::make_shared<FontEntry>();
+        entry = e;
+    }
+
+    std::lock_guard lock(entry->mutex);
+    if (auto font = entry->font.lock())
+        return font;
+
+    auto font = std::make_shared<BitmapFont>(load());
+    entry->font = font;
+    return font;
+}
+
+std::shared_ptr<FontTexture>
+FontRegistry::get_texture(const FontKey& key,
+                          const std::shared_ptr<BitmapFont>& font)
+{
+    std::lock_guard lock(mutex_);
+    auto& weak_texture = textures_[key];
+    if (auto texture = weak_texture.lock())
+    {
+        if (texture->bitmap_font() == font)
+            return texture;
+    }
+
+    auto texture = std::make_shared<FontTexture>(font);
+    weak_texture = texture;
+    return texture;
+}
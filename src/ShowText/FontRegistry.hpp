@@ -0,0 +1,122 @@
+//****************************************************************************
+// Copyright © 2026 Jan Erik Breimo. All rights reserved.
+// Created by Jan Erik Breimo on 2026-10-19.
+//
+// This file is distributed under the BSD License.
+// License text is included with the source distribution.
+//****************************************************************************
+#pragma once
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "BitmapFont.hpp"
+#include "TextureUploader.hpp"
+
+enum class FontMode
+{
+    BITMAP_FONT,
+    RASTERIZED,
+    SHAPED,
+    EMBEDDED
+};
+
+struct FontKey
+{
+    std::string path;
+    unsigned size = 0;
+    FontMode mode = FontMode::BITMAP_FONT;
+    // The sorted characters (or glyph indexes) that are rasterized into
+    // the atlas. Empty when the atlas is read from a file or embedded.
+    std::u32string chars;
+
+    auto operator<=>(const FontKey&) const = default;
+};
+
+/**
+ * @brief A GL texture with the atlas of a bitmap font.
+ *
+ * The atlas is uploaded in chunks by calling update() once per frame.
+ * The texture can be used by every GL context that shares objects with
+ * the one that created it.
+ */
+class FontTexture
+{
+public:
+    explicit FontTexture(std::shared_ptr<BitmapFont> font);
+
+    FontTexture(const FontTexture&) = delete;
+
+    FontTexture& operator=(const FontTexture&) = delete;
+
+    [[nodiscard]]
+    const std::shared_ptr<BitmapFont>& bitmap_font() const;
+
+    [[nodiscard]]
+    GLuint texture() const;
+
+    void bind() const;
+
+    /**
+     * @brief Uploads the next part of the atlas if necessary.
+     * @return true if the entire atlas has been uploaded.
+     */
+    bool update();
+
+    [[nodiscard]]
+    bool is_ready() const;
+
+    [[nodiscard]]
+    size_t texture_memory_usage() const;
+
+    [[nodiscard]]
+    size_t buffer_memory_usage() const;
+private:
+    std::shared_ptr<BitmapFont> font_;
+    Tungsten::TextureHandle texture_;
+    TextureUploader uploader_;
+    size_t texture_size_ = 0;
+    bool ready_ = false;
+};
+
+/**
+ * @brief Shares bitmap fonts and font textures between views.
+ *
+ * Each font is loaded once and each texture is created once for as long
+ * as someone holds a reference to it. get_bitmap_font can be called from
+ * any thread, get_texture only from a thread with a current GL context.
+ */
+class FontRegistry
+{
+public:
+    /**
+     * @brief Returns the font for @a key, calling @a load if it isn't
+     *  already loaded.
+     *
+     * Concurrent calls for the same key wait for a single call to
+     * @a load.
+     */
+    std::shared_ptr<BitmapFont>
+    get_bitmap_font(const FontKey& key,
+                    const std::function<BitmapFont()>& load);
+
+    /**
+     * @brief Returns the texture for @a font, creating it if necessary.
+     *
+     * @throw std::runtime_error if a new texture is needed and @a font's
+     *  image has been released.
+     */
+    std::shared_ptr<FontTexture>
+    get_texture(const FontKey& key, const std::shared_ptr<BitmapFont>& font);
+private:
+    struct FontEntry
+    {
+        std::mutex mutex;
+        std::weak_ptr<BitmapFont> font;
+    };
+
+    std::mutex mutex_;
+    std::map<FontKey, std::shared_ptr<FontEntry>> fonts_;
+    std::map<FontKey, std::weak_ptr<FontTexture>> textures_;
+};
@@ -7,8 +7,128 @@
 //****************************************************************************
 #include "FreeTypeWrapper.hpp"
 
+#include FT_TRUETYPE_TAGS_H
+#include FT_TRUETYPE_TABLES_H
+
+#ifdef _WIN32
+    #define NOMINMAX
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
 namespace freetype
 {
+#ifdef _WIN32
+
+    FontFile::FontFile(const std::string& path)
+        : path_(path)
+    {
+        file_handle_ = CreateFileA(path.c_str(), GENERIC_READ,
+                                   FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                   FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file_handle_ == INVALID_HANDLE_VALUE)
+            throw std::runtime_error("Can't open: " + path);
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file_handle_, &size) || size.QuadPart == 0)
+        {
+            CloseHandle(file_handle_);
+            throw std::runtime_error("Can't get the size of: " + path);
+        }
+        size_ = size_t(size.QuadPart);
+
+        mapping_handle_ = CreateFileMappingA(file_handle_, nullptr,
+                                             PAGE_READONLY, 0, 0, nullptr);
+        if (mapping_handle_)
+        {
+            data_ = static_cast<const FT_Byte*>(
+                MapViewOfFile(mapping_handle_, FILE_MAP_READ, 0, 0, 0));
+        }
+        if (!data_)
+        {
+            if (mapping_handle_)
+                CloseHandle(mapping_handle_);
+            CloseHandle(file_handle_);
+            throw std::runtime_error("Can't map: " + path);
+        }
+    }
+
+    FontFile::~FontFile()
+    {
+        UnmapViewOfFile(data_);
+        CloseHandle(mapping_handle_);
+        CloseHandle(file_handle_);
+    }
+
+#else
+
+    FontFile::FontFile(const std::string& path)
+        : path_(path)
+    {
+        const int fd = open(path.c_str(), O_RDONLY);
+        if (fd == -1)
+            throw std::runtime_error("Can't open: " + path);
+
+        struct stat st = {};
+        if (fstat(fd, &st) == -1 || st.st_size == 0)
+        {
+            close(fd);
+            throw std::runtime_error("Can't get the size of: " + path);
+        }
+        size_ = size_t(st.st_size);
+
+        // The mapping stays valid after the file descriptor is closed.
+        auto* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (data == MAP_FAILED)
+            throw std::runtime_error("Can't map: " + path);
+        data_ = static_cast<const FT_Byte*>(data);
+    }
+
+    FontFile::~FontFile()
+    {
+        munmap(const_cast<FT_Byte*>(data_), size_);
+    }
+
+#endif
+
+    const std::string& FontFile::path() const
+    {
+        return path_;
+    }
+
+    std::span<const FT_Byte> FontFile::data() const
+    {
+        return {data_, size_};
+    }
+
+    std::shared_ptr<const FontFile>
+    FontFileRegistry::get(const std::string& path)
+    {
+        std::lock_guard lock(mutex_);
+        auto& entry = files_[path];
+        if (auto file = entry.lock())
+            return file;
+
+        auto file = std::make_shared<const FontFile>(path);
+        entry = file;
+
+        // Remove entries whose files have been unmapped.
+        std::erase_if(files_, [](auto& e) {return e.second.expired();});
+        return file;
+    }
+
+    FontFileRegistry& font_file_registry()
+    {
+        static FontFileRegistry registry;
+        return registry;
+    }
+
     Library::Library()
     {
         FT_Library library;
@@ -40,18 +160,26 @@ namespace freetype
 
     Face Library::new_face(const std::string& font_path, FT_Long face_index)
     {
+        return new_face(font_file_registry().get(font_path), face_index);
+    }
+
+    Face Library::new_face(std::shared_ptr<const FontFile> file,
+                           FT_Long face_index)
+    {
+        const auto data = file->data();
         FT_Face face;
-        if (auto error = FT_New_Face(library_.get(),
-                                     font_path.c_str(),
-                                     face_index,
-                                     &face))
+        if (auto error = FT_New_Memory_Face(library_.get(),
+                                            data.data(),
+                                            FT_Long(data.size()),
+                                            face_index,
+                                            &face))
         {
-            FREETYPE_THROW("Can't load: " + font_path
-                           + ". FT_New_Face returned "
+            FREETYPE_THROW("Can't load: " + file->path()
+                           + ". FT_New_Memory_Face returned "
                            + std::to_string(error));
         }
 
-        return Face(face);
+        return {face, std::move(file)};
     }
 
     Face::Face() = default;
@@ -60,8 +188,14 @@ namespace freetype
         : face_(face)
     {}
 
+    Face::Face(FT_Face face, std::shared_ptr<const FontFile> file)
+        : file_(std::move(file)),
+          face_(face)
+    {}
+
     Face::Face(Face&& rhs) noexcept
-        : face_(move(rhs.face_))
+        : file_(move(rhs.file_)),
+          face_(move(rhs.face_))
     {}
 
     Face::~Face() = default;
@@ -69,6 +203,7 @@ namespace freetype
     Face& Face::operator=(Face&& rhs) noexcept
     {
         face_ = move(rhs.face_);
+        file_ = move(rhs.file_);
         return *this;
     }
 
@@ -118,4 +253,91 @@ namespace freetype
             FREETYPE_THROW("FT_Load_Char returned " + std::to_string(error));
         }
     }
+
+    void Face::load_glyph(FT_UInt glyph_index, FT_Int32 load_flags)
+    {
+        if (auto error = FT_Load_Glyph(face_.get(), glyph_index, load_flags))
+        {
+            FREETYPE_THROW("FT_Load_Glyph returned " + std::to_string(error));
+        }
+    }
+
+    FT_Vector Face::get_kerning(FT_UInt left_glyph, FT_UInt right_glyph,
+                                FT_UInt kern_mode)
+    {
+        FT_Vector result;
+        if (auto error = FT_Get_Kerning(face_.get(), left_glyph, right_glyph,
+                                        kern_mode, &result))
+        {
+            FREETYPE_THROW("FT_Get_Kerning returned " + std::to_string(error));
+        }
+        return result;
+    }
+
+    namespace
+    {
+        uint16_t read_u16(const std::vector<FT_Byte>& table, size_t offset)
+        {
+            return uint16_t((table[offset] << 8u) | table[offset + 1]);
+        }
+    }
+
+    std::vector<std::pair<FT_UInt, FT_UInt>> Face::get_kerning_pairs()
+    {
+        std::vector<std::pair<FT_UInt, FT_UInt>> result;
+        if (!FT_IS_SFNT(face_.get()))
+            return result;
+
+        FT_ULong length = 0;
+        if (FT_Load_Sfnt_Table(face_.get(), TTAG_kern, 0, nullptr, &length))
+            return result;
+
+        std::vector<FT_Byte> table(length);
+        if (auto error = FT_Load_Sfnt_Table(face_.get(), TTAG_kern, 0,
+                                            table.data(), &length))
+        {
+            FREETYPE_THROW("FT_Load_Sfnt_Table returned "
+                           + std::to_string(error));
+        }
+
+        // Apple's version 1 tables have a 32-bit header and aren't
+        // supported by FT_Get_Kerning either.
+        if (length < 4 || read_u16(table, 0) != 0)
+            return result;
+
+        const auto table_count = read_u16(table, 2);
+        size_t offset = 4;
+        for (unsigned i = 0; i < table_count && offset + 6 <= length; ++i)
+        {
+            const auto subtable_length = read_u16(table, offset + 2);
+            const auto coverage = read_u16(table, offset + 4);
+            const bool is_horizontal = (coverage & 0x1u) != 0;
+            const bool is_cross_stream = (coverage & 0x4u) != 0;
+            const auto format = coverage >> 8u;
+            if (format == 0 && is_horizontal && !is_cross_stream
+                && offset + 14 <= length)
+            {
+                const auto pair_count = read_u16(table, offset + 6);
+                const auto pairs = offset + 14;
+                // The subtable length is a 16-bit value that overflows
+                // in large tables, the pair count is more reliable.
+                for (size_t j = 0; j < pair_count; ++j)
+                {
+                    const auto pair = pairs + j * 6;
+                    if (pair + 6 > length)
+                        break;
+                    result.emplace_back(read_u16(table, pair),
+                                        read_u16(table, pair + 2));
+                }
+                offset = pairs + size_t(pair_count) * 6;
+            }
+            else
+            {
+                if (subtable_length < 6)
+                    break;
+                offset += subtable_length;
+            }
+        }
+        return result;
+    }
 }
@@ -6,10 +6,15 @@
 // License text is included with the source distribution.
 //****************************************************************************
 #pragma once
+#include <map>
 #include <memory>
+#include <mutex>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
@@ -30,6 +35,52 @@ namespace freetype
     #define FREETYPE_THROW(msg) \
         FREETYPE_THROW_2_(__FILE__, __LINE__, msg)
 
+    /**
+     * @brief A font file mapped read-only into memory.
+     */
+    class FontFile
+    {
+    public:
+        explicit FontFile(const std::string& path);
+
+        FontFile(const FontFile&) = delete;
+
+        ~FontFile();
+
+        FontFile& operator=(const FontFile&) = delete;
+
+        [[nodiscard]]
+        const std::string& path() const;
+
+        [[nodiscard]]
+        std::span<const FT_Byte> data() const;
+    private:
+        std::string path_;
+        const FT_Byte* data_ = nullptr;
+        size_t size_ = 0;
+    #ifdef _WIN32
+        void* file_handle_ = nullptr;
+        void* mapping_handle_ = nullptr;
+    #endif
+    };
+
+    /**
+     * @brief Maps each font file only once, no matter how many faces,
+     *  sizes and threads use it.
+     *
+     * A file is unmapped when the last face created from it is destroyed.
+     */
+    class FontFileRegistry
+    {
+    public:
+        std::shared_ptr<const FontFile> get(const std::string& path);
+    private:
+        std::mutex mutex_;
+        std::map<std::string, std::weak_ptr<const FontFile>> files_;
+    };
+
+    FontFileRegistry& font_file_registry();
+
     struct FaceDeleter
     {
         void operator()(FT_Face library)
@@ -48,6 +99,8 @@ namespace freetype
 
         explicit Face(FT_Face face);
 
+        Face(FT_Face face, std::shared_ptr<const FontFile> file);
+
         Face(Face&& rhs) noexcept;
 
         ~Face();
@@ -64,6 +117,12 @@ namespace freetype
         [[nodiscard]]
         FT_Face get();
 
+        /**
+         * @brief Releases ownership of the FT_Face.
+         *
+         * If the face was created from a FontFile, the file remains
+         * mapped until this Face object is destroyed.
+         */
         FacePtr release();
 
         void select_charmap(FT_Encoding encoding);
@@ -71,7 +130,25 @@ namespace freetype
         void set_pixel_sizes(FT_UInt width, FT_UInt height);
 
         void load_char(FT_ULong char_code, FT_Int32 load_flags);
+
+        void load_glyph(FT_UInt glyph_index, FT_Int32 load_flags);
+
+        [[nodiscard]]
+        FT_Vector get_kerning(FT_UInt left_glyph, FT_UInt right_glyph,
+                              FT_UInt kern_mode = FT_KERNING_DEFAULT);
+
+        /**
+         * @brief Returns the glyph pairs in the face's kern table.
+         *
+         * Only horizontal format 0 subtables are read, which are the ones
+         * FT_Get_Kerning uses for SFNT fonts.
+         */
+        [[nodiscard]]
+        std::vector<std::pair<FT_UInt, FT_UInt>> get_kerning_pairs();
     private:
+        // Declared before face_ to ensure the memory is still mapped
+        // when FT_Done_Face is called.
+        std::shared_ptr<const FontFile> file_;
         FacePtr face_;
     };
 
@@ -101,7 +178,14 @@ namespace freetype
 
         LibraryPtr release();
 
+        /**
+         * @brief Creates a face from the mapping of @a font_path in
+         *  font_file_registry().
+         */
         Face new_face(const std::string& font_path, FT_Long face_index = 0);
+
+        Face new_face(std::shared_ptr<const FontFile> file,
+                      FT_Long face_index = 0);
     private:
         LibraryPtr library_;
     };
@@ -7,17 +7,57 @@
 //****************************************************************************
 #include "GlFont.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <thread>
 #include <Tungsten/ArrayBufferBuilder.hpp>
 #include <Ystring/Ystring.hpp>
+#include "Trace.hpp"
+
+namespace
+{
+    // Characters below this value are looked up in a plain array.
+    constexpr char32_t DENSE_CHAR_LIMIT = 0x250;
+}
 
 GlFont::GlFont(std::unordered_map<char32_t, GlCharData> char_data,
-               std::shared_ptr<BitmapFont> bitmap_font)
+               std::shared_ptr<BitmapFont> bitmap_font,
+               Xyz::Vector2F pixel_size)
     : char_data_(std::move(char_data)),
-      bitmap_font_(std::move(bitmap_font))
-{}
+      bitmap_font_(std::move(bitmap_font)),
+      pixel_size_(pixel_size)
+{
+    if (bitmap_font_)
+    {
+        for (const auto& [key, value] : bitmap_font_->all_kerning())
+        {
+            if (auto it = char_data_.find(char32_t(key >> 32u)); it != char_data_.end())
+                it->second.has_kerning = true;
+        }
+    }
+
+    for (const auto& [ch, data] : char_data_)
+    {
+        if (ch >= DENSE_CHAR_LIMIT)
+            continue;
+        if (ch >= dense_char_data_.size())
+            dense_char_data_.resize(ch + 1);
+        dense_char_data_[ch] = data;
+    }
+}
 
 const GlCharData* GlFont::char_data(char32_t ch) const
 {
+    if (ch < dense_char_data_.size())
+    {
+        const auto& data = dense_char_data_[ch];
+        return data ? &*data : nullptr;
+    }
+    if (ch < DENSE_CHAR_LIMIT)
+        return nullptr;
     if (auto it = char_data_.find(ch); it != char_data_.end())
         return &it->second;
     return nullptr;
@@ -30,32 +70,66 @@ const Yimage::Image& GlFont::image() const
     return bitmap_font_->image();
 }
 
+const std::unordered_map<char32_t, GlCharData>& GlFont::all_char_data() const
+{
+    return char_data_;
+}
+
+int GlFont::kerning(char32_t left, char32_t right) const
+{
+    return bitmap_font_ ? bitmap_font_->kerning(left, right) : 0;
+}
+
+std::span<const std::optional<GlCharData>> GlFont::dense_char_data() const
+{
+    return dense_char_data_;
+}
+
+const std::shared_ptr<BitmapFont>& GlFont::bitmap_font() const
+{
+    return bitmap_font_;
+}
+
+const Xyz::Vector2F& GlFont::pixel_size() const
+{
+    return pixel_size_;
+}
+
 GlFont make_gl_font(std::shared_ptr<BitmapFont> bitmap_font,
                     Xyz::Vector2F screen_size)
 {
+    SHOWTEXT_TRACE_SCOPE("make_gl_font");
     if (!bitmap_font)
         throw std::runtime_error("bitmap_font is NULL");
 
     std::unordered_map<char32_t, GlCharData> char_data;
-    const auto& img = bitmap_font->image();
-    if (!img.size())
+    const auto [img_width, img_height] = bitmap_font->image_size();
+    if (img_width == 0 || img_height == 0)
         throw std::runtime_error("BitmapFont instance doesn't contain an image.");
 
     for (const auto [ch, data] : bitmap_font->all_char_data())
     {
         GlCharData gd;
-        gd.tex_origin = {float(data.x) / float(img.width()),
-                         float(data.y + data.height) / float(img.height())};
-        gd.tex_size = {float(data.width) / float(img.width()),
-                       -float(data.height) / float(img.height())};
-        gd.advance = 0.75f * float(2 * float(data.advance) / (64 * screen_size[0]));
+        gd.tex_origin = {float(data.x) / float(img_width),
+                         float(data.y + data.height) / float(img_height)};
+        gd.tex_size = {float(data.width) / float(img_width),
+                       -float(data.height) / float(img_height)};
+        gd.advance_26_6 = data.advance;
         gd.size = {0.75f * 2 * float(data.width) / screen_size[0],
                    0.75f * 2 * float(data.height) / screen_size[1]};
         gd.bearing = {0.75f * 2 * float(data.bearing_x) / screen_size[0],
                       0.75f * 2 * float(data.bearing_y) / screen_size[1]};
         char_data.insert({ch, gd});
     }
-    return {std::move(char_data), std::move(bitmap_font)};
+    Xyz::Vector2F pixel_size = {0.75f * 2 / screen_size[0],
+                                0.75f * 2 / screen_size[1]};
+    return {std::move(char_data), std::move(bitmap_font), pixel_size};
+}
+
+Xyz::Vector2F get_packed_position_scale(const GlFont& font)
+{
+    return {font.pixel_size()[0] / PACKED_SUBPIXELS,
+            font.pixel_size()[1] / PACKED_SUBPIXELS};
 }
 
 std::ostream& operator<<(std::ostream& os, const TextVertex& vertex)
@@ -63,6 +137,12 @@ std::ostream& operator<<(std::ostream& os, const TextVertex& vertex)
     return os << vertex.pos << " -- " << vertex.texture;
 }
 
+std::ostream& operator<<(std::ostream& os, const PackedTextVertex& vertex)
+{
+    return os << '[' << vertex.pos[0] << ", " << vertex.pos[1] << "] -- ["
+              << vertex.texture[0] << ", " << vertex.texture[1] << ']';
+}
+
 std::ostream& operator<<(std::ostream& os,
                          const Tungsten::ArrayBuffer<TextVertex>& buffer)
 {
@@ -77,63 +157,310 @@ std::ostream& operator<<(std::ostream& os,
     return os;
 }
 
-void add_rectangle(Tungsten::ArrayBufferBuilder<TextVertex> builder,
-                   const Xyz::Vector2F& origin,
-                   const Xyz::Vector2F& size,
-                   const Xyz::Vector2F& tex_origin,
-                   const Xyz::Vector2F& tex_size)
+namespace
 {
-    using V = Xyz::Vector2F;
+    template <typename Vertex, typename MakeVertexFunc>
+    std::array<Vertex, 4> make_glyph_vertexes(const GlCharData& cdata,
+                                              const Xyz::Vector2F& origin,
+                                              MakeVertexFunc make_vertex)
+    {
+        using V = Xyz::Vector2F;
 
-    builder.reserve_vertexes(4);
-    builder.add_vertex({origin, tex_origin});
-    builder.add_vertex({origin + V{size[0], 0},
-                        tex_origin + V{tex_size[0], 0}});
-    builder.add_vertex({origin + V{0, size[1]},
-                        tex_origin + V{0, tex_size[1]}});
-    builder.add_vertex({origin + size, tex_origin + tex_size});
-    builder.reserve_indexes(6);
-    builder.add_indexes(0, 1, 2);
-    builder.add_indexes(2, 1, 3);
-}
+        const V pos = {origin[0] + cdata.bearing[0],
+                       origin[1] + cdata.bearing[1] - cdata.size[1]};
+        const auto& size = cdata.size;
+        const auto& tex_origin = cdata.tex_origin;
+        const auto& tex_size = cdata.tex_size;
+        return {make_vertex(pos, tex_origin),
+                make_vertex(pos + V{size[0], 0},
+                            tex_origin + V{tex_size[0], 0}),
+                make_vertex(pos + V{0, size[1]},
+                            tex_origin + V{0, tex_size[1]}),
+                make_vertex(pos + size, tex_origin + tex_size)};
+    }
 
-void format_text(Tungsten::ArrayBuffer<TextVertex>& buffer,
-                 const GlFont& font,
-                 std::u32string_view text,
-                 Xyz::Vector2F origin)
-{
-    for (const auto c : text)
+    // ArrayBuffer has 16-bit indexes, so no more than 0x10000 vertexes
+    // can be referenced.
+    void check_vertex_count(size_t count)
     {
-        auto cdata = font.char_data(c);
-        if (!cdata)
-            continue;
-        add_rectangle(Tungsten::ArrayBufferBuilder<TextVertex>{buffer},
-                      {origin[0] + cdata->bearing[0],
-                       origin[1] + cdata->bearing[1] - cdata->size[1]},
-                      cdata->size,
-                      cdata->tex_origin,
-                      cdata->tex_size);
-        origin[0] += cdata->advance;
+        if (count > 0x10000)
+            throw std::runtime_error("The text has too many glyphs for 16-bit indexes.");
     }
+
+    template <typename Vertex>
+    void add_glyph(Tungsten::ArrayBuffer<Vertex>& buffer,
+                   const std::array<Vertex, 4>& vertexes)
+    {
+        check_vertex_count(buffer.vertexes.size() + 4);
+        Tungsten::ArrayBufferBuilder<Vertex> builder(buffer);
+        builder.reserve_vertexes(4);
+        for (const auto& vertex : vertexes)
+            builder.add_vertex(vertex);
+        builder.reserve_indexes(6);
+        builder.add_indexes(0, 1, 2);
+        builder.add_indexes(2, 1, 3);
+    }
+
+    // The pen position is kept in FreeType's 26.6 fixed point units to
+    // make the result independent of how the text is split between
+    // threads.
+    Xyz::Vector2F get_pen_position(const GlFont& font,
+                                   const Xyz::Vector2F& origin,
+                                   int64_t pen)
+    {
+        return {origin[0] + float(pen) * (font.pixel_size()[0] / 64),
+                origin[1]};
+    }
+
+    template <typename Vertex, typename MakeVertexFunc>
+    void format_text(Tungsten::ArrayBuffer<Vertex>& buffer,
+                     const GlFont& font,
+                     std::u32string_view text,
+                     const Xyz::Vector2F& origin,
+                     MakeVertexFunc make_vertex)
+    {
+        PenWalker pen(font);
+        for (const auto c : text)
+        {
+            auto cdata = pen.next(c);
+            if (!cdata)
+                continue;
+            auto vertexes = make_glyph_vertexes<Vertex>(
+                *cdata, get_pen_position(font, origin, pen.pen()), make_vertex);
+            add_glyph(buffer, vertexes);
+        }
+    }
+
+    struct TextChunk
+    {
+        size_t begin = 0;
+        size_t end = 0;
+        size_t glyphs = 0;
+        int64_t advance = 0;
+    };
+
+    // Exceptions thrown by func are rethrown on the calling thread when
+    // all the threads have finished.
+    template <typename Func>
+    void run_in_parallel(size_t count, Func func)
+    {
+        if (count == 0)
+            return;
+
+        std::vector<std::exception_ptr> errors(count);
+        auto run = [&](size_t i)
+        {
+            try
+            {
+                func(i);
+            }
+            catch (...)
+            {
+                errors[i] = std::current_exception();
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(count - 1);
+        for (size_t i = 1; i < count; ++i)
+            threads.emplace_back(run, i);
+        run(0);
+        for (auto& thread : threads)
+            thread.join();
+        for (const auto& error : errors)
+        {
+            if (error)
+                std::rethrow_exception(error);
+        }
+    }
+
+    // Returns the character before @a pos, for kerning.
+    char32_t get_prev_char(std::u32string_view text, size_t pos)
+    {
+        return pos == 0 ? 0 : text[pos - 1];
+    }
+
+    std::vector<TextChunk>
+    split_text(std::u32string_view text, size_t count)
+    {
+        std::vector<TextChunk> chunks;
+        size_t begin = 0;
+        for (size_t i = 1; i <= count && begin < text.size(); ++i)
+        {
+            auto end = text.size() * i / count;
+            if (end <= begin)
+                continue;
+            // Prefer to split after a newline, as long as the chunk
+            // doesn't grow past the next split point.
+            if (i != count)
+            {
+                auto limit = text.size() * (i + 1) / count;
+                auto nl = text.find(U'\n', end);
+                if (nl != std::u32string_view::npos && nl + 1 < limit)
+                    end = nl + 1;
+            }
+            chunks.push_back({begin, end});
+            begin = end;
+        }
+        return chunks;
+    }
+
+    template <typename Vertex, typename MakeVertexFunc>
+    void format_text_parallel(std::vector<Tungsten::ArrayBuffer<Vertex>>& batches,
+                              const GlFont& font,
+                              std::u32string_view text,
+                              const Xyz::Vector2F& origin,
+                              unsigned thread_count,
+                              MakeVertexFunc make_vertex)
+    {
+        constexpr size_t MIN_CHUNK_SIZE = 4096;
+
+        if (thread_count == 0)
+            thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+        thread_count = unsigned(std::min<size_t>(
+            thread_count, std::max<size_t>(text.size() / MIN_CHUNK_SIZE, 1)));
+
+        // Counting the glyphs first makes it possible to allocate the
+        // buffers up front, which is faster than growing them even on a
+        // single thread.
+        auto chunks = split_text(text, thread_count);
+        run_in_parallel(chunks.size(), [&](size_t i)
+        {
+            auto& chunk = chunks[i];
+            PenWalker pen(font, 0, get_prev_char(text, chunk.begin));
+            for (const auto c : text.substr(chunk.begin, chunk.end - chunk.begin))
+            {
+                if (pen.next(c))
+                    ++chunk.glyphs;
+            }
+            chunk.advance = pen.end();
+        });
+
+        size_t total_glyphs = 0;
+        int64_t total_advance = 0;
+        for (auto& chunk : chunks)
+        {
+            std::swap(chunk.glyphs, total_glyphs);
+            std::swap(chunk.advance, total_advance);
+            total_glyphs += chunk.glyphs;
+            total_advance += chunk.advance;
+        }
+
+        for (size_t glyphs = 0; glyphs < total_glyphs;
+             glyphs += MAX_GLYPHS_PER_BUFFER)
+        {
+            const auto count = std::min(total_glyphs - glyphs,
+                                        MAX_GLYPHS_PER_BUFFER);
+            auto& batch = batches.emplace_back();
+            batch.vertexes.resize(count * 4);
+            batch.indexes.resize(count * 6);
+        }
+
+        // After the prefix sum, glyphs and advance are the number of glyphs
+        // and the pen position before each chunk. A chunk's glyphs can
+        // span several batches.
+        run_in_parallel(chunks.size(), [&](size_t i)
+        {
+            const auto& chunk = chunks[i];
+            auto glyph = chunk.glyphs;
+            PenWalker pen(font, chunk.advance, get_prev_char(text, chunk.begin));
+            for (const auto c : text.substr(chunk.begin, chunk.end - chunk.begin))
+            {
+                auto cdata = pen.next(c);
+                if (!cdata)
+                    continue;
+                auto vertexes = make_glyph_vertexes<Vertex>(
+                    *cdata, get_pen_position(font, origin, pen.pen()), make_vertex);
+                auto& batch = batches[glyph / MAX_GLYPHS_PER_BUFFER];
+                const auto v = (glyph % MAX_GLYPHS_PER_BUFFER) * 4;
+                std::copy(vertexes.begin(), vertexes.end(),
+                          batch.vertexes.begin() + ptrdiff_t(v));
+                auto index = batch.indexes.begin()
+                             + ptrdiff_t((glyph % MAX_GLYPHS_PER_BUFFER) * 6);
+                for (auto offset : {0, 1, 2, 2, 1, 3})
+                    *index++ = uint16_t(v + offset);
+                ++glyph;
+            }
+        });
+    }
+
+    template <typename T>
+    T to_int(float value)
+    {
+        value = std::round(value);
+        if (value < float(std::numeric_limits<T>::min()))
+            return std::numeric_limits<T>::min();
+        if (value > float(std::numeric_limits<T>::max()))
+            return std::numeric_limits<T>::max();
+        return T(value);
+    }
+
+    // Unlike to_int, this doesn't clamp: a clamped position would
+    // silently move the glyph.
+    int16_t to_packed_position(float value)
+    {
+        value = std::round(value);
+        if (value < float(std::numeric_limits<int16_t>::min())
+            || value > float(std::numeric_limits<int16_t>::max()))
+        {
+            throw std::runtime_error("The text is too large for packed vertexes.");
+        }
+        return int16_t(value);
+    }
+
+    struct MakeTextVertex
+    {
+        TextVertex operator()(const Xyz::Vector2F& pos,
+                              const Xyz::Vector2F& tex) const
+        {
+            return {pos, tex};
+        }
+    };
+
+    struct MakeStyledTextVertex
+    {
+        Xyz::Vector4F color;
+
+        StyledTextVertex operator()(const Xyz::Vector2F& pos,
+                                    const Xyz::Vector2F& tex) const
+        {
+            return {pos, tex, color};
+        }
+    };
+
+    struct MakePackedTextVertex
+    {
+        Xyz::Vector2F scale;
+
+        PackedTextVertex operator()(const Xyz::Vector2F& pos,
+                                    const Xyz::Vector2F& tex) const
+        {
+            return {{to_packed_position(pos[0] / scale[0]),
+                     to_packed_position(pos[1] / scale[1])},
+                    {to_int<uint16_t>(tex[0] * 65535.f),
+                     to_int<uint16_t>(tex[1] * 65535.f)}};
+        }
+    };
 }
 
 Xyz::RectangleF get_text_size(const GlFont& font, std::u32string_view text)
 {
     Xyz::Vector2F min, max;
 
+    PenWalker pen(font);
     for (const auto c : text)
     {
-        auto cdata = font.char_data(c);
+        auto cdata = pen.next(c);
         if (!cdata)
             continue;
-        max[0] += cdata->advance;
         auto hi = cdata->bearing[1];
         if (hi > max[1])
             max[1] = hi;
-        auto lo = cdata->size[1] - cdata->bearing[1];
+        auto lo = cdata->bearing[1] - cdata->size[1];
         if (lo < min[1])
             min[1] = lo;
     }
+    max[0] = float(pen.end()) * (font.pixel_size()[0] / 64);
     return {min, max - min};
 }
 
@@ -142,7 +469,228 @@ format_text(const GlFont& font,
             std::u32string_view text,
             const Xyz::Vector2F& origin)
 {
+    SHOWTEXT_TRACE_SCOPE("format_text");
+    Tungsten::ArrayBuffer<TextVertex> result;
+    format_text(result, font, text, origin, MakeTextVertex());
+    return result;
+}
+
+Tungsten::ArrayBuffer<PackedTextVertex>
+format_packed_text(const GlFont& font,
+                   std::u32string_view text,
+                   const Xyz::Vector2F& origin)
+{
+    SHOWTEXT_TRACE_SCOPE("format_packed_text");
+    Tungsten::ArrayBuffer<PackedTextVertex> result;
+    format_text(result, font, text, origin,
+                MakePackedTextVertex{get_packed_position_scale(font)});
+    return result;
+}
+
+float get_max_packed_error(const GlFont& font,
+                           std::u32string_view text,
+                           const Xyz::Vector2F& origin)
+{
+    const auto packed = format_packed_text_parallel(font, text, origin, 1);
+    const auto unpacked = format_text_parallel(font, text, origin, 1);
+    const auto scale = get_packed_position_scale(font);
+    const auto pixel_size = font.pixel_size();
+    // Computed in double to not add float rounding errors to the result.
+    double max_error = 0;
+    for (size_t b = 0; b < unpacked.size(); ++b)
+    {
+        for (size_t i = 0; i < unpacked[b].vertexes.size(); ++i)
+        {
+            const auto& p = packed[b].vertexes[i];
+            const auto& u = unpacked[b].vertexes[i];
+            for (size_t j = 0; j < 2; ++j)
+            {
+                auto error = std::abs(double(p.pos[j]) * scale[j] - u.pos[j])
+                             / pixel_size[j];
+                max_error = std::max(max_error, error);
+            }
+        }
+    }
+    return float(max_error);
+}
+
+void append_text(Tungsten::ArrayBuffer<TextVertex>& buffer,
+                 const GlFont& font,
+                 std::u32string_view text,
+                 const Xyz::Vector2F& origin)
+{
+    format_text(buffer, font, text, origin, MakeTextVertex());
+}
+
+Xyz::RectangleF get_shaped_text_size(const GlFont& font,
+                                     std::span<const ShapedGlyph> glyphs)
+{
+    const auto unit = font.pixel_size()[1] / 64;
+    Xyz::Vector2F min, max;
+    int64_t pen_x = 0;
+    for (const auto& glyph : glyphs)
+    {
+        pen_x += glyph.x_advance;
+        auto cdata = font.char_data(glyph.glyph_index);
+        if (!cdata)
+            continue;
+        auto y = float(glyph.y_offset) * unit;
+        auto hi = y + cdata->bearing[1];
+        if (hi > max[1])
+            max[1] = hi;
+        auto lo = y + cdata->bearing[1] - cdata->size[1];
+        if (lo < min[1])
+            min[1] = lo;
+    }
+    max[0] = float(pen_x) * (font.pixel_size()[0] / 64);
+    return {min, max - min};
+}
+
+Tungsten::ArrayBuffer<TextVertex>
+format_shaped_text(const GlFont& font,
+                   std::span<const ShapedGlyph> glyphs,
+                   const Xyz::Vector2F& origin)
+{
+    SHOWTEXT_TRACE_SCOPE("format_shaped_text");
     Tungsten::ArrayBuffer<TextVertex> result;
-    format_text(result, font, text, origin);
+    const auto unit = font.pixel_size()[1] / 64;
+    int64_t pen_x = 0, pen_y = 0;
+    for (const auto& glyph : glyphs)
+    {
+        if (auto cdata = font.char_data(glyph.glyph_index))
+        {
+            auto pos = get_pen_position(font, origin, pen_x + glyph.x_offset);
+            pos[1] += float(pen_y + glyph.y_offset) * unit;
+            auto vertexes = make_glyph_vertexes<TextVertex>(*cdata, pos,
+                                                            MakeTextVertex());
+            add_glyph(result, vertexes);
+        }
+        pen_x += glyph.x_advance;
+        pen_y += glyph.y_advance;
+    }
+    return result;
+}
+
+std::vector<Tungsten::ArrayBuffer<TextVertex>>
+format_text_parallel(const GlFont& font,
+                     std::u32string_view text,
+                     const Xyz::Vector2F& origin,
+                     unsigned thread_count)
+{
+    SHOWTEXT_TRACE_SCOPE("format_text_parallel");
+    std::vector<Tungsten::ArrayBuffer<TextVertex>> result;
+    format_text_parallel(result, font, text, origin, thread_count,
+                         MakeTextVertex());
+    return result;
+}
+
+std::vector<Tungsten::ArrayBuffer<PackedTextVertex>>
+format_packed_text_parallel(const GlFont& font,
+                            std::u32string_view text,
+                            const Xyz::Vector2F& origin,
+                            unsigned thread_count)
+{
+    SHOWTEXT_TRACE_SCOPE("format_packed_text_parallel");
+    std::vector<Tungsten::ArrayBuffer<PackedTextVertex>> result;
+    format_text_parallel(result, font, text, origin, thread_count,
+                         MakePackedTextVertex{get_packed_position_scale(font)});
+    return result;
+}
+
+namespace
+{
+    struct DecorationMetrics
+    {
+        // The top of the underline relative to the baseline.
+        float underline_top = 0;
+        // The top of the strikethrough relative to the baseline.
+        float strikethrough_top = 0;
+        float thickness = 0;
+    };
+
+    // The bitmap fonts don't have the font's underline metrics,
+    // approximate them from the glyphs.
+    DecorationMetrics get_decoration_metrics(const GlFont& font)
+    {
+        const auto& bitmap_font = *font.bitmap_font();
+        const auto [lo, hi] = bitmap_font.vertical_extremes();
+        const auto thickness = std::max(1.f, std::round(float(hi - lo) / 16));
+        const auto underline_top = std::min(-1.f, std::round(float(lo) / 2));
+        auto x_height = float(hi) / 2;
+        if (auto x = bitmap_font.char_data('x'))
+            x_height = float(x->bearing_y);
+        const auto strikethrough_top = std::round((x_height + thickness) / 2);
+        const auto unit = font.pixel_size()[1];
+        return {underline_top * unit,
+                strikethrough_top * unit,
+                thickness * unit};
+    }
+
+    void add_decoration(Tungsten::ArrayBuffer<StyledTextVertex>& buffer,
+                        const Xyz::Vector2F& pos,
+                        float width, float top, float thickness,
+                        const Xyz::Vector4F& color)
+    {
+        GlCharData cdata;
+        cdata.size = {width, thickness};
+        cdata.bearing = {0, top};
+        cdata.tex_origin = {-1, -1};
+        add_glyph(buffer, make_glyph_vertexes<StyledTextVertex>(
+            cdata, pos, MakeStyledTextVertex{color}));
+    }
+}
+
+Tungsten::ArrayBuffer<StyledTextVertex>
+format_styled_text(const GlFont& font,
+                   std::u32string_view text,
+                   std::span<const StyleRun> runs,
+                   const Xyz::Vector2F& origin)
+{
+    SHOWTEXT_TRACE_SCOPE("format_styled_text");
+    Tungsten::ArrayBuffer<StyledTextVertex> result;
+    const auto metrics = get_decoration_metrics(font);
+    PenWalker pen(font);
+    size_t pos = 0;
+    auto add_segment = [&](size_t end, const TextStyle& style)
+    {
+        const auto start_pen = pen.end();
+        const MakeStyledTextVertex make_vertex{style.color};
+        for (end = std::min(end, text.size()); pos < end; ++pos)
+        {
+            auto cdata = pen.next(text[pos]);
+            if (!cdata)
+                continue;
+            auto vertexes = make_glyph_vertexes<StyledTextVertex>(
+                *cdata, get_pen_position(font, origin, pen.pen()), make_vertex);
+            add_glyph(result, vertexes);
+        }
+
+        if (pen.end() == start_pen)
+            return;
+        const auto start = get_pen_position(font, origin, start_pen);
+        const auto width = float(pen.end() - start_pen) * (font.pixel_size()[0] / 64);
+        if (style.underline)
+        {
+            add_decoration(result, start, width, metrics.underline_top,
+                           metrics.thickness, style.color);
+        }
+        if (style.strikethrough)
+        {
+            add_decoration(result, start, width, metrics.strikethrough_top,
+                           metrics.thickness, style.color);
+        }
+    };
+
+    const TextStyle default_style;
+    size_t prev_end = 0;
+    for (const auto& run : runs)
+    {
+        if (run.begin < prev_end || run.end < run.begin)
+            throw std::runtime_error("Style runs must be sorted and can't overlap.");
+        add_segment(run.begin, default_style);
+        add_segment(run.end, run.style);
+        prev_end = run.end;
+    }
+    add_segment(text.size(), default_style);
     return result;
 }
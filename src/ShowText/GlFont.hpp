@@ -6,8 +6,10 @@
 // License text is included with the source distribution.
 //****************************************************************************
 #pragma once
+#include <optional>
 #include <span>
 #include <unordered_map>
+#include <vector>
 #include <Tungsten/ArrayBuffer.hpp>
 #include <Xyz/Rectangle.hpp>
 #include <Xyz/Vector.hpp>
@@ -18,9 +20,11 @@ struct GlCharData
 {
     Xyz::Vector2F size;
     Xyz::Vector2F bearing;
-    float advance = {};
+    int advance_26_6 = {};
     Xyz::Vector2F tex_origin;
     Xyz::Vector2F tex_size;
+    // True if the character is the left character in a kerning pair.
+    bool has_kerning = false;
 };
 
 class GlFont
@@ -29,29 +33,139 @@ public:
     GlFont() = default;
 
     GlFont(std::unordered_map<char32_t, GlCharData> char_data,
-           std::shared_ptr<BitmapFont> bitmap_font);
+           std::shared_ptr<BitmapFont> bitmap_font,
+           Xyz::Vector2F pixel_size);
 
     [[nodiscard]]
     const GlCharData* char_data(char32_t ch) const;
 
+    [[nodiscard]]
+    const std::unordered_map<char32_t, GlCharData>& all_char_data() const;
+
+    /**
+     * @brief Returns the kerning between @a left and @a right in 26.6
+     *  fixed point format.
+     */
+    [[nodiscard]]
+    int kerning(char32_t left, char32_t right) const;
+
+    [[nodiscard]]
+    std::span<const std::optional<GlCharData>> dense_char_data() const;
+
     [[nodiscard]]
     const Yimage::Image& image() const;
+
+    [[nodiscard]]
+    const std::shared_ptr<BitmapFont>& bitmap_font() const;
+
+    [[nodiscard]]
+    const Xyz::Vector2F& pixel_size() const;
 private:
     std::unordered_map<char32_t, GlCharData> char_data_;
+    std::vector<std::optional<GlCharData>> dense_char_data_;
     std::shared_ptr<BitmapFont> bitmap_font_;
+    Xyz::Vector2F pixel_size_;
 };
 
 GlFont make_gl_font(std::shared_ptr<BitmapFont> bitmap_font,
                     Xyz::Vector2F screen_size);
 
+/**
+ * @brief Returns the kerning in 26.6 fixed point format between the
+ *  adjacent characters @a prev and @a ch.
+ *
+ * @a prev_data and @a data are the characters' data in @a font, they
+ * are NULL if @a font doesn't have them.
+ */
+inline int get_kerning(const GlFont& font,
+                       char32_t prev, const GlCharData* prev_data,
+                       char32_t ch, const GlCharData* data)
+{
+    if (!prev_data || !prev_data->has_kerning || !data)
+        return 0;
+    return font.kerning(prev, ch);
+}
+
+/**
+ * @brief Moves a pen across text one character at a time, applying
+ *  kerning and advances in 26.6 fixed point format.
+ *
+ * Every function that positions characters uses this to ensure they
+ * all place them identically.
+ */
+class PenWalker
+{
+public:
+    /**
+     * @brief Starts at @a pen, after the character @a prev (0 if there
+     *  is none) that the first character is kerned against.
+     */
+    explicit PenWalker(const GlFont& font, int64_t pen = 0, char32_t prev = 0)
+        : font_(&font),
+          pen_(pen),
+          prev_(prev),
+          prev_data_(prev ? font.char_data(prev) : nullptr)
+    {}
+
+    /**
+     * @brief Moves the pen to @a ch and returns its data, or NULL if
+     *  the font doesn't have it.
+     *
+     * pen() is then the position of @a ch and end() the position after
+     * it.
+     */
+    const GlCharData* next(char32_t ch)
+    {
+        const auto data = font_->char_data(ch);
+        pen_ += advance_ + get_kerning(*font_, prev_, prev_data_, ch, data);
+        advance_ = data ? data->advance_26_6 : 0;
+        prev_ = ch;
+        prev_data_ = data;
+        return data;
+    }
+
+    [[nodiscard]]
+    int64_t pen() const
+    {
+        return pen_;
+    }
+
+    [[nodiscard]]
+    int64_t end() const
+    {
+        return pen_ + advance_;
+    }
+private:
+    const GlFont* font_;
+    int64_t pen_ = 0;
+    int64_t advance_ = 0;
+    char32_t prev_ = 0;
+    const GlCharData* prev_data_ = nullptr;
+};
+
 struct TextVertex
 {
     Xyz::Vector2F pos;
     Xyz::Vector2F texture;
 };
 
+// Positions are in units of 1/PACKED_SUBPIXELS bitmap pixels and must be
+// scaled by get_packed_position_scale(). Texture coordinates are
+// normalized.
+struct PackedTextVertex
+{
+    int16_t pos[2];
+    uint16_t texture[2];
+};
+
+constexpr int PACKED_SUBPIXELS = 4;
+
+Xyz::Vector2F get_packed_position_scale(const GlFont& font);
+
 std::ostream& operator<<(std::ostream& os, const TextVertex& vertex);
 
+std::ostream& operator<<(std::ostream& os, const PackedTextVertex& vertex);
+
 std::ostream&
 operator<<(std::ostream& os, const Tungsten::ArrayBuffer<TextVertex>& buffer);
 
@@ -61,3 +175,131 @@ Tungsten::ArrayBuffer<TextVertex>
 format_text(const GlFont& font,
             std::u32string_view text,
             const Xyz::Vector2F& origin);
+
+/**
+ * @brief Formats @a text with 16-bit positions.
+ *
+ * @throw std::runtime_error if a position is too far from the center
+ *  of the screen to be represented, i.e. beyond ±8191 pixels.
+ */
+Tungsten::ArrayBuffer<PackedTextVertex>
+format_packed_text(const GlFont& font,
+                   std::u32string_view text,
+                   const Xyz::Vector2F& origin);
+
+/**
+ * @brief Returns the largest difference, in pixels, between a packed
+ *  position of @a text and the same position formatted with floats.
+ *
+ * Positions are rounded to the nearest 1/PACKED_SUBPIXELS pixel, so the
+ * difference should never exceed 1/8 pixel plus the rounding error of
+ * the float positions, which is well below 1/1000 pixel.
+ */
+float get_max_packed_error(const GlFont& font,
+                           std::u32string_view text,
+                           const Xyz::Vector2F& origin);
+
+/**
+ * @brief Adds the glyphs in @a text to @a buffer, the result is the same
+ *  as that of format_text.
+ *
+ * @throw std::runtime_error if the glyphs don't fit in @a buffer's
+ *  16-bit indexes. The glyphs that did fit are left in @a buffer.
+ */
+void append_text(Tungsten::ArrayBuffer<TextVertex>& buffer,
+                 const GlFont& font,
+                 std::u32string_view text,
+                 const Xyz::Vector2F& origin);
+
+/**
+ * @brief A glyph produced by a text shaper.
+ *
+ * Advances and offsets are in FreeType's 26.6 fixed point format.
+ */
+struct ShapedGlyph
+{
+    char32_t glyph_index = 0;
+    uint32_t cluster = 0;
+    int x_advance = 0;
+    int y_advance = 0;
+    int x_offset = 0;
+    int y_offset = 0;
+};
+
+Xyz::RectangleF get_shaped_text_size(const GlFont& font,
+                                     std::span<const ShapedGlyph> glyphs);
+
+/**
+ * @brief Formats shaped text with a font made by make_glyph_bitmap_font.
+ */
+Tungsten::ArrayBuffer<TextVertex>
+format_shaped_text(const GlFont& font,
+                   std::span<const ShapedGlyph> glyphs,
+                   const Xyz::Vector2F& origin);
+
+/**
+ * @brief The number of glyphs that fit in an ArrayBuffer with 16-bit
+ *  indexes.
+ */
+constexpr size_t MAX_GLYPHS_PER_BUFFER = 0x10000 / 4;
+
+/**
+ * @brief Produces the same glyphs as format_text, but splits the text
+ *  between @a thread_count threads and places the glyphs in as many
+ *  buffers as needed to fit 16-bit indexes.
+ *
+ * Every buffer but the last has MAX_GLYPHS_PER_BUFFER glyphs, and the
+ * buffers must be drawn one at a time. The text is split at newlines
+ * where possible. A @a thread_count of 0 uses one thread per core.
+ * Short texts are formatted on the calling thread.
+ */
+std::vector<Tungsten::ArrayBuffer<TextVertex>>
+format_text_parallel(const GlFont& font,
+                     std::u32string_view text,
+                     const Xyz::Vector2F& origin,
+                     unsigned thread_count = 0);
+
+std::vector<Tungsten::ArrayBuffer<PackedTextVertex>>
+format_packed_text_parallel(const GlFont& font,
+                            std::u32string_view text,
+                            const Xyz::Vector2F& origin,
+                            unsigned thread_count = 0);
+
+struct TextStyle
+{
+    Xyz::Vector4F color = {1, 1, 1, 1};
+    bool underline = false;
+    bool strikethrough = false;
+};
+
+/**
+ * @brief Applies @a style to the characters in the range [begin, end).
+ */
+struct StyleRun
+{
+    size_t begin = 0;
+    size_t end = 0;
+    TextStyle style;
+};
+
+struct StyledTextVertex
+{
+    Xyz::Vector2F pos;
+    Xyz::Vector2F texture;
+    Xyz::Vector4F color;
+};
+
+/**
+ * @brief Formats text where each run of characters has its own color
+ *  and decorations.
+ *
+ * The runs must be sorted and can't overlap, characters that aren't in
+ * any run get the default TextStyle. Underlines and strikethroughs are
+ * added as quads with negative texture coordinates, the whole text can
+ * therefore be drawn with a single draw call.
+ */
+Tungsten::ArrayBuffer<StyledTextVertex>
+format_styled_text(const GlFont& font,
+                   std::u32string_view text,
+                   std::span<const StyleRun> runs,
+                   const Xyz::Vector2F& origin);
@@ -0,0 +1,82 @@
+//****************************************************************************
+// Copyright © 2026 Jan Erik Breimo. All rights reserved.
+// Created by Jan Erik Breimo on 2026-10-19.
+//
+// This file is distributed under the BSD License.
+// License text is included with the source distribution.
+//****************************************************************************
+#include "MemoryUsage.hpp"
+
+#include <iomanip>
+#include <ostream>
+
+size_t MemoryUsage::cpu_total() const
+{
+    return atlas_image + glyph_tables + hash_overhead;
+}
+
+size_t MemoryUsage::gpu_total() const
+{
+    return gpu_buffers + gpu_textures;
+}
+
+size_t MemoryUsage::total() const
+{
+    return cpu_total() + gpu_total();
+}
+
+MemoryUsage& MemoryUsage::operator+=(const MemoryUsage& rhs)
+{
+    atlas_image += rhs.atlas_image;
+    glyph_tables += rhs.glyph_tables;
+    hash_overhead += rhs.hash_overhead;
+    gpu_buffers += rhs.gpu_buffers;
+    gpu_textures += rhs.gpu_textures;
+    return *this;
+}
+
+MemoryUsage operator+(MemoryUsage lhs, const MemoryUsage& rhs)
+{
+    return lhs += rhs;
+}
+
+std::ostream& operator<<(std::ostream& os, const MemoryUsage& usage)
+{
+    auto line = [&](const char* label, size_t bytes)
+    {
+        os << "  " << std::left << std::setw(16) << label
+           << std::right << std::setw(12) << bytes << " bytes\n";
+    };
+    line("Atlas image:", usage.atlas_image);
+    line("Glyph tables:", usage.glyph_tables);
+    line("Hash overhead:", usage.hash_overhead);
+    line("GPU buffers:", usage.gpu_buffers);
+    line("GPU textures:", usage.gpu_textures);
+    line("Total:", usage.total());
+    return os;
+}
+
+MemoryUsage get_memory_usage(const BitmapFont& font)
+{
+    using Map = std::unordered_map<char32_t, BitmapCharData>;
+    const auto& char_data = font.all_char_data();
+    MemoryUsage result;
+    result.atlas_image = font.image().size();
+    result.glyph_tables = char_data.size() * sizeof(Map::value_type)
+                          + font.all_kerning().size()
+                            * sizeof(KerningTable::value_type);
+    result.hash_overhead = get_hash_overhead(char_data)
+                           + get_hash_overhead(font.all_kerning());
+    return result;
+}
+
+MemoryUsage get_memory_usage(const GlFont& font)
+{
+    using Map = std::unordered_map<char32_t, GlCharData>;
+    const auto& char_data = font.all_char_data();
+    MemoryUsage result;
+    result.glyph_tables = char_data.size() * sizeof(Map::value_type)
+                          + font.dense_char_data().size_bytes();
+    result.hash_overhead = get_hash_overhead(char_data);
+    return result;
+}
@@ -0,0 +1,55 @@
+//****************************************************************************
+// Copyright © 2026 Jan Erik Breimo. All rights reserved.
+// Created by Jan Erik Breimo on 2026-10-19.
+//
+// This file is distributed under the BSD License.
+// License text is included with the source distribution.
+//****************************************************************************
+#pragma once
+#include <iosfwd>
+#include <unordered_map>
+#include "BitmapFont.hpp"
+#include "GlFont.hpp"
+
+struct MemoryUsage
+{
+    size_t atlas_image = 0;
+    size_t glyph_tables = 0;
+    size_t hash_overhead = 0;
+    size_t gpu_buffers = 0;
+    size_t gpu_textures = 0;
+
+    [[nodiscard]]
+    size_t cpu_total() const;
+
+    [[nodiscard]]
+    size_t gpu_total() const;
+
+    [[nodiscard]]
+    size_t total() const;
+
+    MemoryUsage& operator+=(const MemoryUsage& rhs);
+};
+
+MemoryUsage operator+(MemoryUsage lhs, const MemoryUsage& rhs);
+
+std::ostream& operator<<(std::ostream& os, const MemoryUsage& usage);
+
+/**
+ * @brief An estimate of the memory used by the nodes and buckets of
+ *  @a map, in addition to the keys and values themselves.
+ */
+template <typename K, typename V>
+size_t get_hash_overhead(const std::unordered_map<K, V>& map)
+{
+    // Every node has a next-pointer, every bucket is a pointer.
+    return map.size() * sizeof(void*) + map.bucket_count() * sizeof(void*);
+}
+
+MemoryUsage get_memory_usage(const BitmapFont& font);
+
+/**
+ * @brief Returns the memory used by @a font's own tables, not by the
+ *  bitmap font it refers to.
+ */
+MemoryUsage get_memory_usage(const GlFont& font);
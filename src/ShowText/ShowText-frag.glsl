@@ -8,16 +8,24 @@
 #version 100
 
 varying highp vec2 v_TextureCoord;
+varying highp vec4 v_Color;
 
 uniform sampler2D u_Texture;
 uniform highp vec4 u_TextColor;
 
 void main()
 {
-    highp vec4 texCol = texture2D(u_Texture, v_TextureCoord);
-    highp float value = max(texCol.r, max(texCol.g, texCol.b));
-    gl_FragColor = vec4(u_TextColor.r * value,
-                        u_TextColor.g * value,
-                        u_TextColor.b * value,
-                        u_TextColor.a);
+    highp vec4 color = u_TextColor * v_Color;
+    // Underlines and other decorations have negative texture
+    // coordinates and are drawn as solid rectangles.
+    highp float value = 1.0;
+    if (v_TextureCoord.x >= 0.0)
+    {
+        highp vec4 texCol = texture2D(u_Texture, v_TextureCoord);
+        value = max(texCol.r, max(texCol.g, texCol.b));
+    }
+    gl_FragColor = vec4(color.r * value,
+                        color.g * value,
+                        color.b * value,
+                        color.a);
 }
@@ -9,13 +9,16 @@
 
 attribute vec2 a_Position;
 attribute vec2 a_TextureCoord;
+attribute vec4 a_Color;
 
 uniform mat4 u_MvpMatrix;
 
 varying highp vec2 v_TextureCoord;
+varying highp vec4 v_Color;
 
 void main()
 {
     gl_Position = u_MvpMatrix * vec4(a_Position, 0, 1);
     v_TextureCoord = a_TextureCoord;
+    v_Color = a_Color;
 }
@@ -10,9 +10,11 @@
 #include <Tungsten/ShaderProgramBuilder.hpp>
 #include "ShowText-frag.glsl.hpp"
 #include "ShowText-vert.glsl.hpp"
+#include "Trace.hpp"
 
 void ShowTextShaderProgram::setup()
 {
+    SHOWTEXT_TRACE_SCOPE("ShowTextShaderProgram::setup");
     using namespace Tungsten;
     program = ShaderProgramBuilder()
         .add_shader(ShaderType::VERTEX, ShowText_vert)
@@ -23,6 +25,7 @@ void ShowTextShaderProgram::setup()
 
     position = Tungsten::get_vertex_attribute(program, "a_Position");
     texture_coord = Tungsten::get_vertex_attribute(program, "a_TextureCoord");
+    vertex_color = Tungsten::get_vertex_attribute(program, "a_Color");
 
     mvp_matrix = Tungsten::get_uniform<Xyz::Matrix4F>(program, "u_MvpMatrix");
     texture = Tungsten::get_uniform<GLint>(program, "u_Texture");
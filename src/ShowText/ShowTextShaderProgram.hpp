@@ -21,4 +21,5 @@ public:
 
     GLuint position;
     GLuint texture_coord;
+    GLuint vertex_color;
 };
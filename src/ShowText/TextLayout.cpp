@@ -0,0 +1,166 @@
+//****************************************************************************
+// Copyright © 2026 Jan Erik Breimo. All rights reserved.
+// Created by Jan Erik Breimo on 2026-10-19.
+//
+// This file is distributed under the BSD License.
+// License text is included with the source distribution.
+//****************************************************************************
+#include "TextLayout.hpp"
+
+#include <algorithm>
+#include "Trace.hpp"
+
+namespace
+{
+    // Returns the lowest and highest point of the font's glyphs
+    // relative to the baseline.
+    std::pair<float, float> get_line_extents(const GlFont& font)
+    {
+        float lo = 0, hi = 0;
+        for (const auto& [ch, cdata] : font.all_char_data())
+        {
+            hi = std::max(hi, cdata.bearing[1]);
+            lo = std::min(lo, cdata.bearing[1] - cdata.size[1]);
+        }
+        return {lo, hi};
+    }
+}
+
+TextLayout::TextLayout()
+    : lines_(1),
+      offsets_{0}
+{}
+
+TextLayout::TextLayout(const GlFont& font,
+                       std::u32string_view text,
+                       const Xyz::Vector2F& origin)
+    : origin_x_(origin[0]),
+      caret_width_(font.pixel_size()[0])
+{
+    SHOWTEXT_TRACE_SCOPE("TextLayout");
+    const auto [lo, hi] = get_line_extents(font);
+    const auto unit = font.pixel_size()[0] / 64;
+    offsets_.reserve(text.size() + 1);
+    float width = 0;
+    size_t begin = 0;
+    while (true)
+    {
+        const auto end = std::min(text.find(U'\n', begin), text.size());
+        const auto baseline = origin[1] - float(lines_.size()) * (hi - lo);
+        lines_.push_back({begin, end, baseline, baseline + lo, baseline + hi});
+
+        PenWalker pen(font);
+        offsets_.push_back(0);
+        for (auto i = begin; i < end; ++i)
+        {
+            pen.next(text[i]);
+            offsets_.push_back(float(pen.end()) * unit);
+        }
+        width = std::max(width, offsets_.back());
+
+        append_text(buffer_, font, text.substr(begin, end - begin),
+                    {origin[0], baseline});
+
+        if (end == text.size())
+            break;
+        begin = end + 1;
+    }
+
+    bounds_ = {Xyz::Vector2F{origin[0], lines_.back().bottom},
+               Xyz::Vector2F{width, lines_.front().top - lines_.back().bottom}};
+}
+
+const Tungsten::ArrayBuffer<TextVertex>& TextLayout::buffer() const
+{
+    return buffer_;
+}
+
+std::span<const TextLine> TextLayout::lines() const
+{
+    return lines_;
+}
+
+size_t TextLayout::size() const
+{
+    return offsets_.size() - 1;
+}
+
+const Xyz::RectangleF& TextLayout::bounds() const
+{
+    return bounds_;
+}
+
+size_t TextLayout::find_line(size_t index) const
+{
+    index = std::min(index, size());
+    auto it = std::upper_bound(lines_.begin(), lines_.end(), index,
+                               [](size_t i, const TextLine& line)
+                               {
+                                   return i < line.begin;
+                               });
+    return size_t(it - lines_.begin()) - 1;
+}
+
+size_t TextLayout::find_line_at(float y) const
+{
+    // The lines are sorted from top to bottom.
+    auto it = std::partition_point(lines_.begin(), lines_.end(),
+                                   [y](const TextLine& line)
+                                   {
+                                       return line.bottom > y;
+                                   });
+    if (it == lines_.end())
+        --it;
+    return size_t(it - lines_.begin());
+}
+
+size_t TextLayout::find_caret(const Xyz::Vector2F& point) const
+{
+    const auto& line = lines_[find_line_at(point[1])];
+    const auto x = point[0] - origin_x_;
+    const auto first = offsets_.begin() + ptrdiff_t(line.begin);
+    const auto last = offsets_.begin() + ptrdiff_t(line.end + 1);
+    auto it = std::lower_bound(first, last, x);
+    if (it == first)
+        return line.begin;
+    if (it == last)
+        return line.end;
+    const auto index = size_t(it - offsets_.begin());
+    if (x - offsets_[index - 1] < offsets_[index] - x)
+        return index - 1;
+    return index;
+}
+
+Xyz::RectangleF TextLayout::caret_rectangle(size_t index) const
+{
+    const auto& line = lines_[find_line(index)];
+    return {Xyz::Vector2F{caret_x(std::min(index, size())), line.bottom},
+            Xyz::Vector2F{caret_width_, line.top - line.bottom}};
+}
+
+std::vector<Xyz::RectangleF>
+TextLayout::selection_rectangles(size_t first, size_t last) const
+{
+    last = std::min(last, size());
+    std::vector<Xyz::RectangleF> result;
+    if (first >= last)
+        return result;
+
+    for (auto i = find_line(first); i < lines_.size() && lines_[i].begin < last; ++i)
+    {
+        const auto& line = lines_[i];
+        const auto x0 = caret_x(std::max(first, line.begin));
+        auto x1 = caret_x(std::min(last, line.end));
+        // Show that the newline is selected, also on empty lines.
+        if (last > line.end)
+            x1 += caret_width_;
+        result.push_back({Xyz::Vector2F{x0, line.bottom},
+                          Xyz::Vector2F{x1 - x0, line.top - line.bottom}});
+    }
+    return result;
+}
+
+float TextLayout::caret_x(size_t index) const
+{
+    return origin_x_ + offsets_[index];
+}
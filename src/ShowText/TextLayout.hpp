@@ -0,0 +1,117 @@
+//****************************************************************************
+// Copyright © 2026 Jan Erik Breimo. All rights reserved.
+// Created by Jan Erik Breimo on 2026-10-19.
+//
+// This file is distributed under the BSD License.
+// License text is included with the source distribution.
+//****************************************************************************
+#pragma once
+#include <span>
+#include <string>
+#include <vector>
+#include "GlFont.hpp"
+
+struct TextLine
+{
+    // The index of the line's first character.
+    size_t begin = 0;
+    // The index of the newline that ends the line, or the text's length.
+    size_t end = 0;
+    float baseline = 0;
+    float bottom = 0;
+    float top = 0;
+};
+
+/**
+ * @brief Text that has been split into lines at newlines and laid out,
+ *  together with what is needed to map between positions and
+ *  characters.
+ *
+ * The x positions of the carets are kept as prefix sums and the lines
+ * are sorted from top to bottom. Hit testing and finding carets are
+ * therefore binary searches.
+ *
+ * Positions are in the same coordinates as the vertexes, and a caret
+ * index is in the range [0, text length].
+ */
+class TextLayout
+{
+public:
+    TextLayout();
+
+    /**
+     * @brief Lays out @a text with the baseline of the first line
+     *  starting at @a origin.
+     *
+     * @throw std::runtime_error if @a text has more than 16384 glyphs.
+     */
+    TextLayout(const GlFont& font,
+               std::u32string_view text,
+               const Xyz::Vector2F& origin);
+
+    /**
+     * @brief The glyphs of all the lines, as format_text would have
+     *  made them.
+     *
+     * The buffer has 16-bit indexes and holds at most 16384 glyphs.
+     */
+    [[nodiscard]]
+    const Tungsten::ArrayBuffer<TextVertex>& buffer() const;
+
+    [[nodiscard]]
+    std::span<const TextLine> lines() const;
+
+    /**
+     * @brief The number of characters in the text.
+     */
+    [[nodiscard]]
+    size_t size() const;
+
+    [[nodiscard]]
+    const Xyz::RectangleF& bounds() const;
+
+    /**
+     * @brief Returns the index of the line that contains caret @a index.
+     */
+    [[nodiscard]]
+    size_t find_line(size_t index) const;
+
+    /**
+     * @brief Returns the index of the line at @a y, the first or last
+     *  line if @a y is above or below the text.
+     */
+    [[nodiscard]]
+    size_t find_line_at(float y) const;
+
+    /**
+     * @brief Returns the caret that is closest to @a point.
+     */
+    [[nodiscard]]
+    size_t find_caret(const Xyz::Vector2F& point) const;
+
+    /**
+     * @brief Returns the rectangle of the caret in front of the
+     *  character at @a index.
+     */
+    [[nodiscard]]
+    Xyz::RectangleF caret_rectangle(size_t index) const;
+
+    /**
+     * @brief Returns one rectangle per line for the characters in the
+     *  range [first, last).
+     */
+    [[nodiscard]]
+    std::vector<Xyz::RectangleF>
+    selection_rectangles(size_t first, size_t last) const;
+private:
+    [[nodiscard]]
+    float caret_x(size_t index) const;
+
+    Tungsten::ArrayBuffer<TextVertex> buffer_;
+    std::vector<TextLine> lines_;
+    // The x position of each caret relative to the start of its line.
+    std::vector<float> offsets_;
+    Xyz::RectangleF bounds_;
+    float origin_x_ = 0;
+    float caret_width_ = 0;
+};
@@ -0,0 +1,159 @@
+//****************************************************************************
+// Copyright © 2026 Jan Erik Breimo. All rights reserved.
+// Created by Jan Erik Breimo on 2026-10-19.
+//
+// This file is distributed under the BSD License.
+// License text is included with the source distribution.
+//****************************************************************************
+#include "TextMeasurement.hpp"
+
+#include <algorithm>
+
+namespace
+{
+    struct VerticalExtremes
+    {
+        float lo = 0;
+        float hi = 0;
+
+        void add(const GlCharData& cdata)
+        {
+            hi = std::max(hi, cdata.bearing[1]);
+            lo = std::min(lo, cdata.bearing[1] - cdata.size[1]);
+        }
+
+        [[nodiscard]]
+        Xyz::RectangleF rectangle(float width) const
+        {
+            return {Xyz::Vector2F{0, lo}, Xyz::Vector2F{width, hi - lo}};
+        }
+    };
+}
+
+MeasuredText::MeasuredText()
+    : offsets_{0}
+{}
+
+MeasuredText::MeasuredText(const GlFont& font, std::u32string_view text)
+{
+    offsets_.reserve(text.size() + 1);
+    offsets_.push_back(0);
+    VerticalExtremes extremes;
+    const auto unit = font.pixel_size()[0] / 64;
+    PenWalker pen(font);
+    for (const auto c : text)
+    {
+        if (auto cdata = pen.next(c))
+            extremes.add(*cdata);
+        offsets_.push_back(float(pen.end()) * unit);
+    }
+    bounds_ = extremes.rectangle(offsets_.back());
+}
+
+size_t MeasuredText::size() const
+{
+    return offsets_.size() - 1;
+}
+
+float MeasuredText::width() const
+{
+    return offsets_.back();
+}
+
+float MeasuredText::width(size_t count) const
+{
+    return offsets_[std::min(count, size())];
+}
+
+float MeasuredText::width(size_t first, size_t last) const
+{
+    return width(last) - width(first);
+}
+
+size_t MeasuredText::fit(float max_width) const
+{
+    if (max_width < 0)
+        return 0;
+    auto it = std::upper_bound(offsets_.begin(), offsets_.end(), max_width);
+    return size_t(it - offsets_.begin()) - 1;
+}
+
+const Xyz::RectangleF& MeasuredText::bounds() const
+{
+    return bounds_;
+}
+
+std::span<const float> MeasuredText::offsets() const
+{
+    return offsets_;
+}
+
+namespace
+{
+    float get_width(const GlFont& font, std::u32string_view text)
+    {
+        PenWalker pen(font);
+        for (const auto c : text)
+        {
+            if (!pen.next(c))
+                return -1;
+        }
+        return float(pen.end()) * (font.pixel_size()[0] / 64);
+    }
+}
+
+TextFit fit_text(const GlFont& font,
+                 const MeasuredText& text,
+                 float max_width)
+{
+    if (text.width() <= max_width)
+        return {text.size(), {}, text.width()};
+
+    std::u32string_view ellipsis = U"…";
+    auto ellipsis_width = get_width(font, ellipsis);
+    if (ellipsis_width < 0)
+    {
+        ellipsis = U"...";
+        ellipsis_width = get_width(font, ellipsis);
+        if (ellipsis_width < 0)
+        {
+            ellipsis = {};
+            ellipsis_width = 0;
+        }
+    }
+
+    if (ellipsis_width > max_width)
+        return {0, {}, 0};
+
+    auto length = text.fit(max_width - ellipsis_width);
+    return {length, ellipsis, text.width(length) + ellipsis_width};
+}
+
+std::u32string ellipsize_text(const GlFont& font,
+                              std::u32string_view text,
+                              float max_width)
+{
+    auto fit = fit_text(font, MeasuredText(font, text), max_width);
+    std::u32string result(text.substr(0, fit.length));
+    result += fit.ellipsis;
+    return result;
+}
+
+std::vector<Xyz::RectangleF>
+get_text_sizes(const GlFont& font, std::span<const std::u32string_view> texts)
+{
+    std::vector<Xyz::RectangleF> result;
+    result.reserve(texts.size());
+    for (const auto& text : texts)
+    {
+        VerticalExtremes extremes;
+        PenWalker pen(font);
+        for (const auto c : text)
+        {
+            if (auto cdata = pen.next(c))
+                extremes.add(*cdata);
+        }
+        result.push_back(extremes.rectangle(float(pen.end()) * (font.pixel_size()[0] / 64)));
+    }
+    return result;
+}
@@ -0,0 +1,85 @@
+//****************************************************************************
+// Copyright © 2026 Jan Erik Breimo. All rights reserved.
+// Created by Jan Erik Breimo on 2026-10-19.
+//
+// This file is distributed under the BSD License.
+// License text is included with the source distribution.
+//****************************************************************************
+#pragma once
+#include <span>
+#include <string>
+#include <vector>
+#include "GlFont.hpp"
+
+/**
+ * @brief The advances of a string stored as prefix sums.
+ *
+ * Measuring a substring or finding how many characters fit in a given
+ * width doesn't require another pass over the string.
+ */
+class MeasuredText
+{
+public:
+    MeasuredText();
+
+    MeasuredText(const GlFont& font, std::u32string_view text);
+
+    [[nodiscard]]
+    size_t size() const;
+
+    [[nodiscard]]
+    float width() const;
+
+    /**
+     * @brief The width of the first @a count characters.
+     */
+    [[nodiscard]]
+    float width(size_t count) const;
+
+    [[nodiscard]]
+    float width(size_t first, size_t last) const;
+
+    /**
+     * @brief Returns the number of leading characters whose total advance
+     *  is at most @a max_width.
+     */
+    [[nodiscard]]
+    size_t fit(float max_width) const;
+
+    /**
+     * @brief The same rectangle as get_text_size returns.
+     */
+    [[nodiscard]]
+    const Xyz::RectangleF& bounds() const;
+
+    [[nodiscard]]
+    std::span<const float> offsets() const;
+private:
+    std::vector<float> offsets_;
+    Xyz::RectangleF bounds_;
+};
+
+struct TextFit
+{
+    size_t length = 0;
+    std::u32string_view ellipsis;
+    float width = 0;
+};
+
+/**
+ * @brief Finds how much of @a text fits in @a max_width when text that
+ *  is too long must end with an ellipsis.
+ *
+ * The ellipsis is "…" if the font has it, otherwise "...". The result's
+ * ellipsis is empty if the entire text fits.
+ */
+TextFit fit_text(const GlFont& font,
+                 const MeasuredText& text,
+                 float max_width);
+
+std::u32string ellipsize_text(const GlFont& font,
+                              std::u32string_view text,
+                              float max_width);
+
+std::vector<Xyz::RectangleF>
+get_text_sizes(const GlFont& font, std::span<const std::u32string_view> texts);
@@ -0,0 +1,166 @@
+//****************************************************************************
+// Copyright © 2026 Jan Erik Breimo. All rights reserved.
+// Created by Jan Erik Breimo on 2026-10-19.
+//
+// This file is distributed under the BSD License.
+// License text is included with the source distribution.
+//****************************************************************************
+#include "TextShaper.hpp"
+
+#include <ostream>
+#include <hb-ft.h>
+#include "Trace.hpp"
+
+size_t ShapedRunKeyHash::operator()(const ShapedRunKey& key) const
+{
+    auto hash = std::hash<std::u32string>()(key.text);
+    hash = hash * 31 + std::hash<std::string>()(key.font);
+    hash = hash * 31 + size_t(key.script);
+    return hash * 31 + size_t(key.direction);
+}
+
+std::ostream& operator<<(std::ostream& os, const ShapingStatistics& stats)
+{
+    using namespace std::chrono;
+    const auto lookups = stats.hits + stats.misses;
+    const auto seconds = duration<double>(stats.shaping_time).count();
+    os << "Shaping: " << stats.shaped_chars << " characters in "
+       << duration_cast<microseconds>(stats.shaping_time).count() << " us";
+    if (seconds > 0)
+        os << " (" << size_t(double(stats.shaped_chars) / seconds) << " characters/s)";
+    os << ", cache hits: " << stats.hits << '/' << lookups << '\n';
+    return os;
+}
+
+ShapedRunCache::ShapedRunCache(size_t capacity)
+    : capacity_(capacity)
+{}
+
+std::shared_ptr<const ShapedRun> ShapedRunCache::find(const ShapedRunKey& key)
+{
+    std::lock_guard lock(mutex_);
+    auto it = index_.find(key);
+    if (it == index_.end())
+    {
+        ++statistics_.misses;
+        return {};
+    }
+
+    ++statistics_.hits;
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return it->second->second;
+}
+
+void ShapedRunCache::insert(ShapedRunKey key,
+                            std::shared_ptr<const ShapedRun> run)
+{
+    std::lock_guard lock(mutex_);
+    if (auto it = index_.find(key); it != index_.end())
+    {
+        it->second->second = std::move(run);
+        entries_.splice(entries_.begin(), entries_, it->second);
+        return;
+    }
+
+    if (capacity_ == 0)
+        return;
+
+    if (entries_.size() == capacity_)
+    {
+        index_.erase(entries_.back().first);
+        entries_.pop_back();
+    }
+
+    entries_.emplace_front(std::move(key), std::move(run));
+    index_.insert({entries_.front().first, entries_.begin()});
+}
+
+void ShapedRunCache::add_shaping_time(size_t chars,
+                                      std::chrono::nanoseconds time)
+{
+    std::lock_guard lock(mutex_);
+    statistics_.shaped_chars += chars;
+    statistics_.shaping_time += time;
+}
+
+ShapingStatistics ShapedRunCache::statistics() const
+{
+    std::lock_guard lock(mutex_);
+    return statistics_;
+}
+
+TextShaper::TextShaper(const std::string& font_path, unsigned font_size,
+                       std::shared_ptr<ShapedRunCache> cache)
+    : font_id_(font_path + ":" + std::to_string(font_size)),
+      cache_(std::move(cache))
+{
+    if (!cache_)
+        cache_ = std::make_shared<ShapedRunCache>();
+
+    face_ = library_.new_face(font_path);
+    face_.select_charmap(FT_ENCODING_UNICODE);
+    face_.set_pixel_sizes(0, font_size);
+    font_ = hb_ft_font_create_referenced(face_.get());
+    buffer_ = hb_buffer_create();
+    if (!hb_buffer_allocation_successful(buffer_))
+    {
+        hb_font_destroy(font_);
+        hb_buffer_destroy(buffer_);
+        throw std::runtime_error("Can't create HarfBuzz buffer.");
+    }
+}
+
+TextShaper::~TextShaper()
+{
+    hb_buffer_destroy(buffer_);
+    hb_font_destroy(font_);
+}
+
+std::shared_ptr<const ShapedRun>
+TextShaper::shape(std::u32string_view text,
+                  hb_script_t script,
+                  hb_direction_t direction)
+{
+    SHOWTEXT_TRACE_SCOPE("TextShaper::shape");
+    ShapedRunKey key{font_id_, script, direction, std::u32string(text)};
+    if (auto run = cache_->find(key))
+        return run;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    hb_buffer_reset(buffer_);
+    hb_buffer_add_utf32(buffer_,
+                        reinterpret_cast<const uint32_t*>(text.data()),
+                        int(text.size()), 0, int(text.size()));
+    if (script != HB_SCRIPT_INVALID)
+        hb_buffer_set_script(buffer_, script);
+    if (direction != HB_DIRECTION_INVALID)
+        hb_buffer_set_direction(buffer_, direction);
+    hb_buffer_guess_segment_properties(buffer_);
+    hb_shape(font_, buffer_, nullptr, 0);
+
+    unsigned count = 0;
+    const auto* infos = hb_buffer_get_glyph_infos(buffer_, &count);
+    const auto* positions = hb_buffer_get_glyph_positions(buffer_, &count);
+    auto run = std::make_shared<ShapedRun>();
+    run->reserve(count);
+    for (unsigned i = 0; i < count; ++i)
+    {
+        run->push_back({char32_t(infos[i].codepoint),
+                        infos[i].cluster,
+                        positions[i].x_advance,
+                        positions[i].y_advance,
+                        positions[i].x_offset,
+                        positions[i].y_offset});
+    }
+
+    cache_->add_shaping_time(text.size(),
+                             std::chrono::steady_clock::now() - start);
+    cache_->insert(std::move(key), run);
+    return run;
+}
+
+const std::shared_ptr<ShapedRunCache>& TextShaper::cache() const
+{
+    return cache_;
+}
@@ -0,0 +1,112 @@
+//****************************************************************************
+// Copyright © 2026 Jan Erik Breimo. All rights reserved.
+// Created by Jan Erik Breimo on 2026-10-19.
+//
+// This file is distributed under the BSD License.
+// License text is included with the source distribution.
+//****************************************************************************
+#pragma once
+#include <chrono>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <hb.h>
+#include "FreeTypeWrapper.hpp"
+#include "GlFont.hpp"
+
+using ShapedRun = std::vector<ShapedGlyph>;
+
+struct ShapedRunKey
+{
+    std::string font;
+    hb_script_t script = HB_SCRIPT_INVALID;
+    hb_direction_t direction = HB_DIRECTION_INVALID;
+    std::u32string text;
+
+    bool operator==(const ShapedRunKey&) const = default;
+};
+
+struct ShapedRunKeyHash
+{
+    size_t operator()(const ShapedRunKey& key) const;
+};
+
+struct ShapingStatistics
+{
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t shaped_chars = 0;
+    std::chrono::nanoseconds shaping_time = {};
+};
+
+std::ostream& operator<<(std::ostream& os, const ShapingStatistics& stats);
+
+/**
+ * @brief A thread-safe LRU cache of shaped runs.
+ */
+class ShapedRunCache
+{
+public:
+    explicit ShapedRunCache(size_t capacity = 1024);
+
+    std::shared_ptr<const ShapedRun> find(const ShapedRunKey& key);
+
+    void insert(ShapedRunKey key, std::shared_ptr<const ShapedRun> run);
+
+    void add_shaping_time(size_t chars, std::chrono::nanoseconds time);
+
+    [[nodiscard]]
+    ShapingStatistics statistics() const;
+private:
+    using Entry = std::pair<ShapedRunKey, std::shared_ptr<const ShapedRun>>;
+
+    size_t capacity_;
+    mutable std::mutex mutex_;
+    std::list<Entry> entries_;
+    std::unordered_map<ShapedRunKey, std::list<Entry>::iterator,
+                       ShapedRunKeyHash> index_;
+    ShapingStatistics statistics_;
+};
+
+/**
+ * @brief Shapes text with HarfBuzz using a FreeType face.
+ *
+ * The glyph indexes in the result are the keys of the bitmap font
+ * returned by make_glyph_bitmap_font for the same font and size.
+ * A TextShaper must only be used by one thread at a time, but several
+ * shapers can share the same cache.
+ */
+class TextShaper
+{
+public:
+    TextShaper(const std::string& font_path, unsigned font_size,
+               std::shared_ptr<ShapedRunCache> cache = {});
+
+    TextShaper(const TextShaper&) = delete;
+
+    ~TextShaper();
+
+    TextShaper& operator=(const TextShaper&) = delete;
+
+    /**
+     * @brief Shapes @a text, script and direction are detected from the
+     *  text if they are invalid.
+     */
+    std::shared_ptr<const ShapedRun>
+    shape(std::u32string_view text,
+          hb_script_t script = HB_SCRIPT_INVALID,
+          hb_direction_t direction = HB_DIRECTION_INVALID);
+
+    [[nodiscard]]
+    const std::shared_ptr<ShapedRunCache>& cache() const;
+private:
+    std::string font_id_;
+    freetype::Library library_;
+    freetype::Face face_;
+    hb_font_t* font_ = nullptr;
+    hb_buffer_t* buffer_ = nullptr;
+    std::shared_ptr<ShapedRunCache> cache_;
+};
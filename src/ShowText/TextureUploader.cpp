@@ -0,0 +1,201 @@
+//****************************************************************************
+// Copyright © 2026 Jan Erik Breimo. All rights reserved.
+// Created by Jan Erik Breimo on 2026-10-19.
+//
+// This file is distributed under the BSD License.
+// License text is included with the source distribution.
+//****************************************************************************
+#include "TextureUploader.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include "Trace.hpp"
+
+std::pair<int, int> get_ogl_pixel_type(Yimage::PixelType type)
+{
+    switch (type)
+    {
+    case Yimage::PixelType::MONO_8:
+        return {GL_RED, GL_UNSIGNED_BYTE};
+    case Yimage::PixelType::MONO_ALPHA_8:
+        return {GL_RG, GL_UNSIGNED_BYTE};
+    case Yimage::PixelType::RGB_8:
+        return {GL_RGB, GL_UNSIGNED_BYTE};
+    case Yimage::PixelType::RGBA_8:
+        return {GL_RGBA, GL_UNSIGNED_BYTE};
+    case Yimage::PixelType::MONO_1:
+    case Yimage::PixelType::MONO_2:
+    case Yimage::PixelType::MONO_4:
+    case Yimage::PixelType::MONO_16:
+    case Yimage::PixelType::ALPHA_MONO_8:
+    case Yimage::PixelType::ALPHA_MONO_16:
+    case Yimage::PixelType::MONO_ALPHA_16:
+    case Yimage::PixelType::RGB_16:
+    case Yimage::PixelType::ARGB_8:
+    case Yimage::PixelType::ARGB_16:
+    case Yimage::PixelType::RGBA_16:
+    default:
+        break;
+    }
+    throw std::runtime_error("GLES has no corresponding pixel format: "
+                             + std::to_string(int(type)));
+}
+
+namespace
+{
+    constexpr size_t BUFFER_COUNT = 3;
+}
+
+TextureUploader::TextureUploader(size_t chunk_size)
+    : chunk_size_(chunk_size)
+{}
+
+TextureUploader::TextureUploader(TextureUploader&& rhs) noexcept
+    : target_(rhs.target_),
+      texture_(rhs.texture_),
+      chunk_size_(rhs.chunk_size_),
+      buffers_(std::move(rhs.buffers_)),
+      next_buffer_(rhs.next_buffer_),
+      max_chunk_size_(rhs.max_chunk_size_),
+      regions_(std::move(rhs.regions_)),
+      fences_(std::move(rhs.fences_))
+{
+    rhs.fences_.clear();
+}
+
+TextureUploader::~TextureUploader()
+{
+    delete_fences();
+}
+
+TextureUploader& TextureUploader::operator=(TextureUploader&& rhs) noexcept
+{
+    delete_fences();
+    target_ = rhs.target_;
+    texture_ = rhs.texture_;
+    chunk_size_ = rhs.chunk_size_;
+    buffers_ = std::move(rhs.buffers_);
+    next_buffer_ = rhs.next_buffer_;
+    max_chunk_size_ = rhs.max_chunk_size_;
+    regions_ = std::move(rhs.regions_);
+    fences_ = std::move(rhs.fences_);
+    rhs.fences_.clear();
+    return *this;
+}
+
+void TextureUploader::set_texture(GLenum target, GLuint texture)
+{
+    target_ = target;
+    texture_ = texture;
+}
+
+void TextureUploader::add_image(const Yimage::Image& image)
+{
+    add_region(image, 0, 0, image.width(), image.height());
+}
+
+void TextureUploader::add_region(const Yimage::Image& image,
+                                 unsigned x, unsigned y,
+                                 unsigned width, unsigned height)
+{
+    if (x + width > image.width() || y + height > image.height())
+        throw std::runtime_error("Region is outside the image.");
+    if (width == 0 || height == 0)
+        return;
+
+    auto [format, type] = get_ogl_pixel_type(image.pixel_type());
+    const auto stride = image.size() / image.height();
+    const auto pixel_size = stride / image.width();
+    regions_.push_back({image.data() + y * stride + x * pixel_size,
+                        stride, pixel_size,
+                        GLenum(format), GLenum(type),
+                        x, y, width, height});
+}
+
+bool TextureUploader::has_pending_data() const
+{
+    return !regions_.empty();
+}
+
+void TextureUploader::upload_next_chunk()
+{
+    SHOWTEXT_TRACE_SCOPE("upload_next_chunk");
+    if (regions_.empty())
+        return;
+
+    if (buffers_.empty())
+        buffers_ = Tungsten::generate_buffers(BUFFER_COUNT);
+
+    auto& region = regions_.front();
+    const auto row_size = region.width * region.pixel_size;
+    const auto rows = std::min<size_t>(region.height - region.next_row,
+                                       std::max<size_t>(chunk_size_ / row_size, 1));
+    const auto size = GLsizeiptr(rows * row_size);
+    max_chunk_size_ = std::max(max_chunk_size_, size_t(size));
+
+    Tungsten::bind_buffer(GL_PIXEL_UNPACK_BUFFER, buffers_[next_buffer_]);
+    next_buffer_ = (next_buffer_ + 1) % buffers_.size();
+    // Orphaning the buffer lets the driver hand us fresh memory if the GL
+    // is still reading the previous chunk that used it.
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    auto dst = static_cast<uint8_t*>(glMapBufferRange(
+        GL_PIXEL_UNPACK_BUFFER, 0, size,
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+    if (!dst)
+    {
+        Tungsten::bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        throw std::runtime_error("glMapBufferRange failed.");
+    }
+
+    auto src = region.data + region.next_row * region.stride;
+    for (size_t i = 0; i < rows; ++i)
+        std::memcpy(dst + i * row_size, src + i * region.stride, row_size);
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+    Tungsten::bind_texture(target_, texture_);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(target_, 0,
+                    GLint(region.x), GLint(region.y + region.next_row),
+                    GLsizei(region.width), GLsizei(rows),
+                    region.format, region.type, nullptr);
+    Tungsten::bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    fences_.push_back(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+
+    region.next_row += unsigned(rows);
+    if (region.next_row == region.height)
+        regions_.pop_front();
+}
+
+bool TextureUploader::is_complete()
+{
+    while (!fences_.empty())
+    {
+        auto status = glClientWaitSync(fences_.front(), 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+            return false;
+        glDeleteSync(fences_.front());
+        fences_.pop_front();
+    }
+    return regions_.empty();
+}
+
+size_t TextureUploader::buffer_memory_usage() const
+{
+    return buffers_.size() * max_chunk_size_;
+}
+
+void TextureUploader::release_buffers()
+{
+    buffers_.clear();
+    next_buffer_ = 0;
+    max_chunk_size_ = 0;
+}
+
+void TextureUploader::delete_fences()
+{
+    for (auto fence : fences_)
+        glDeleteSync(fence);
+    fences_.clear();
+}
@@ -0,0 +1,90 @@
+//****************************************************************************
+// Copyright © 2026 Jan Erik Breimo. All rights reserved.
+// Created by Jan Erik Breimo on 2026-10-19.
+//
+// This file is distributed under the BSD License.
+// License text is included with the source distribution.
+//****************************************************************************
+#pragma once
+#include <deque>
+#include <vector>
+#include <Tungsten/Tungsten.hpp>
+#include <Yimage/Image.hpp>
+
+std::pair<int, int> get_ogl_pixel_type(Yimage::PixelType type);
+
+/**
+ * @brief Streams image data to a texture through pixel buffer objects.
+ *
+ * Regions are copied in chunks of at most @a chunk_size bytes, one chunk
+ * per call to upload_next_chunk(). The images passed to add_region must
+ * stay alive until has_pending_data() returns false.
+ */
+class TextureUploader
+{
+public:
+    explicit TextureUploader(size_t chunk_size = 256 * 1024);
+
+    TextureUploader(TextureUploader&&) noexcept;
+
+    ~TextureUploader();
+
+    TextureUploader& operator=(TextureUploader&&) noexcept;
+
+    void set_texture(GLenum target, GLuint texture);
+
+    void add_image(const Yimage::Image& image);
+
+    void add_region(const Yimage::Image& image,
+                    unsigned x, unsigned y,
+                    unsigned width, unsigned height);
+
+    [[nodiscard]]
+    bool has_pending_data() const;
+
+    void upload_next_chunk();
+
+    /**
+     * @brief Returns true when every region has been uploaded and the
+     *  GL has finished reading it.
+     */
+    [[nodiscard]]
+    bool is_complete();
+
+    /**
+     * @brief The number of bytes allocated for pixel buffer objects.
+     */
+    [[nodiscard]]
+    size_t buffer_memory_usage() const;
+
+    /**
+     * @brief Deletes the pixel buffer objects, they are recreated if
+     *  more regions are added.
+     */
+    void release_buffers();
+private:
+    struct Region
+    {
+        const uint8_t* data;
+        size_t stride;
+        size_t pixel_size;
+        GLenum format;
+        GLenum type;
+        unsigned x;
+        unsigned y;
+        unsigned width;
+        unsigned height;
+        unsigned next_row = 0;
+    };
+
+    void delete_fences();
+
+    GLenum target_ = GL_TEXTURE_2D;
+    GLuint texture_ = 0;
+    size_t chunk_size_;
+    std::vector<Tungsten::BufferHandle> buffers_;
+    size_t next_buffer_ = 0;
+    size_t max_chunk_size_ = 0;
+    std::deque<Region> regions_;
+    std::deque<GLsync> fences_;
+};
@@ -0,0 +1,103 @@
+//****************************************************************************
+// Copyright © 2026 Jan Erik Breimo. All rights reserved.
+// Created by Jan Erik Breimo on 2026-10-19.
+//
+// This file is distributed under the BSD License.
+// License text is included with the source distribution.
+//****************************************************************************
+#include "Trace.hpp"
+
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include <Yson/JsonWriter.hpp>
+
+namespace trace
+{
+    namespace
+    {
+        using Clock = std::chrono::steady_clock;
+
+        struct SpanRecord
+        {
+            const char* name;
+            int64_t start;
+            int64_t end;
+            int thread_id;
+        };
+
+        std::mutex mutex;
+        std::vector<SpanRecord> spans;
+        int next_thread_id = 0;
+
+        int get_thread_id()
+        {
+            thread_local int id = -1;
+            if (id == -1)
+            {
+                std::lock_guard lock(mutex);
+                id = next_thread_id++;
+            }
+            return id;
+        }
+    }
+
+    namespace detail
+    {
+        std::atomic<bool> enabled = false;
+    }
+
+    int64_t to_trace_time(std::chrono::steady_clock::time_point time)
+    {
+        using namespace std::chrono;
+        return duration_cast<microseconds>(time.time_since_epoch()).count();
+    }
+
+    int64_t now()
+    {
+        return to_trace_time(Clock::now());
+    }
+
+    void add_span(const char* name, int64_t start, int64_t end)
+    {
+        if (!is_enabled())
+            return;
+        auto thread_id = get_thread_id();
+        std::lock_guard lock(mutex);
+        spans.push_back({name, start, end, thread_id});
+    }
+
+    void enable()
+    {
+        detail::enabled = true;
+    }
+
+    void write(const std::string& file_name)
+    {
+        std::vector<SpanRecord> records;
+        {
+            std::lock_guard lock(mutex);
+            records = spans;
+        }
+
+        Yson::JsonWriter writer(file_name, Yson::JsonFormatting::FORMAT);
+        constexpr auto FLAT = Yson::JsonParameters(Yson::JsonFormatting::FLAT);
+        writer.beginObject();
+        writer.key("displayTimeUnit").value(std::string("ms"));
+        writer.key("traceEvents").beginArray();
+        for (const auto& span : records)
+        {
+            writer.beginObject(FLAT);
+            writer.key("name").value(std::string(span.name));
+            writer.key("cat").value(std::string("ShowText"));
+            writer.key("ph").value(std::string("X"));
+            writer.key("ts").value(span.start);
+            writer.key("dur").value(span.end - span.start);
+            writer.key("pid").value(1);
+            writer.key("tid").value(span.thread_id);
+            writer.endObject();
+        }
+        writer.endArray();
+        writer.endObject();
+    }
+}
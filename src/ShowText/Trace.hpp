@@ -0,0 +1,96 @@
+//****************************************************************************
+// Copyright © 2026 Jan Erik Breimo. All rights reserved.
+// Created by Jan Erik Breimo on 2026-10-19.
+//
+// This file is distributed under the BSD License.
+// License text is included with the source distribution.
+//****************************************************************************
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace trace
+{
+    namespace detail
+    {
+        extern std::atomic<bool> enabled;
+    }
+
+    /**
+     * @brief Returns @a time in the trace's time unit, microseconds.
+     */
+    [[nodiscard]]
+    int64_t to_trace_time(std::chrono::steady_clock::time_point time);
+
+    [[nodiscard]]
+    int64_t now();
+
+    /**
+     * @brief Adds a span that can't be recorded with a Span instance,
+     *  e.g. one that started before tracing was enabled.
+     */
+    void add_span(const char* name, int64_t start, int64_t end);
+
+    /**
+     * @brief Starts recording spans. Spans are discarded until this
+     *  function has been called.
+     */
+    void enable();
+
+    [[nodiscard]]
+    inline bool is_enabled()
+    {
+        return detail::enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Writes the recorded spans as a Chrome trace that can be
+     *  opened in chrome://tracing or Perfetto.
+     */
+    void write(const std::string& file_name);
+
+    /**
+     * @brief Records the time from construction to destruction.
+     *
+     * @a name must be a string literal or otherwise outlive the trace.
+     * Only an atomic load is done when tracing isn't enabled.
+     */
+    class Span
+    {
+    public:
+        explicit Span(const char* name)
+            : name_(is_enabled() ? name : nullptr),
+              start_(name_ ? now() : 0)
+        {}
+
+        Span(const Span&) = delete;
+
+        ~Span()
+        {
+            end();
+        }
+
+        Span& operator=(const Span&) = delete;
+
+        /**
+         * @brief Ends the span before the end of the scope.
+         */
+        void end()
+        {
+            if (name_)
+                add_span(name_, start_, now());
+            name_ = nullptr;
+        }
+    private:
+        const char* name_;
+        int64_t start_;
+    };
+}
+
+#define SHOWTEXT_TRACE_CONCAT_2_(a, b) a##b
+#define SHOWTEXT_TRACE_CONCAT_(a, b) SHOWTEXT_TRACE_CONCAT_2_(a, b)
+
+#define SHOWTEXT_TRACE_SCOPE(name) \
+    ::trace::Span SHOWTEXT_TRACE_CONCAT_(trace_span_, __LINE__)(name)
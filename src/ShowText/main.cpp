@@ -5,6 +5,11 @@
 // This file is distributed under the BSD License.
 // License text is included with the source distribution.
 //****************************************************************************
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <functional>
+#include <future>
 #include <iostream>
 #include <unordered_set>
 #include <Argos/Argos.hpp>
@@ -12,48 +17,57 @@
 #include <Yimage/Yimage.hpp>
 #include <Ystring/Ystring.hpp>
 #include "BitmapFont.hpp"
+#include "EmbeddedFont.hpp"
 #include "ShowTextShaderProgram.hpp"
+#include "FontRegistry.hpp"
 #include "GlFont.hpp"
+#include "MemoryUsage.hpp"
+#include "Trace.hpp"
 
-namespace
+#ifdef SHOWTEXT_HAS_DEFAULT_FONT
+    #include "DefaultFont.hpp"
+#endif
+
+#ifdef SHOWTEXT_USE_HARFBUZZ
+    #include "TextShaper.hpp"
+#endif
+
+using Clock = std::chrono::steady_clock;
+
+struct LoadedFont
 {
-    std::pair<int, int> get_ogl_pixel_type(Yimage::PixelType type)
-    {
-        switch (type)
-        {
-        case Yimage::PixelType::MONO_8:
-            return {GL_RED, GL_UNSIGNED_BYTE};
-        case Yimage::PixelType::MONO_ALPHA_8:
-            return {GL_RG, GL_UNSIGNED_BYTE};
-        case Yimage::PixelType::RGB_8:
-            return {GL_RGB, GL_UNSIGNED_BYTE};
-        case Yimage::PixelType::RGBA_8:
-            return {GL_RGBA, GL_UNSIGNED_BYTE};
-        case Yimage::PixelType::MONO_1:
-        case Yimage::PixelType::MONO_2:
-        case Yimage::PixelType::MONO_4:
-        case Yimage::PixelType::MONO_16:
-        case Yimage::PixelType::ALPHA_MONO_8:
-        case Yimage::PixelType::ALPHA_MONO_16:
-        case Yimage::PixelType::MONO_ALPHA_16:
-        case Yimage::PixelType::RGB_16:
-        case Yimage::PixelType::ARGB_8:
-        case Yimage::PixelType::ARGB_16:
-        case Yimage::PixelType::RGBA_16:
-        default:
-            break;
-        }
-        throw std::runtime_error("GLES has no corresponding pixel format: "
-                                 + std::to_string(int(type)));
-    }
-}
+    std::shared_ptr<BitmapFont> bitmap_font;
+    // Only set when the text has been shaped, the bitmap font's keys
+    // are then glyph indexes.
+    std::shared_ptr<const std::vector<ShapedGlyph>> shaped_text;
+    // The key the bitmap font was loaded with.
+    FontKey font_key;
+};
+
+struct ShowTextOptions
+{
+    bool packed_vertexes = false;
+    bool verify_packed_vertexes = false;
+    bool print_timing = false;
+    bool print_stats = false;
+    bool release_image = false;
+    unsigned layout_threads = 1;
+    // The text is formatted with format_styled_text when this isn't empty.
+    std::vector<StyleRun> style_runs;
+    Clock::time_point start_time;
+};
 
 class ShowText : public Tungsten::EventLoop
 {
 public:
-    ShowText(std::shared_ptr<BitmapFont> font, std::u32string text)
-        : bmp_font_(std::move(font)),
-          text_(std::move(text))
+    ShowText(std::shared_ptr<FontRegistry> registry,
+             std::future<LoadedFont> font,
+             std::u32string text,
+             ShowTextOptions options)
+        : registry_(std::move(registry)),
+          pending_bmp_font_(std::move(font)),
+          text_(std::move(text)),
+          options_(options)
     {}
 
     void on_startup(Tungsten::SdlApplication& app) override
@@ -61,48 +75,29 @@ public:
         int w, h;
         SDL_GetWindowSize(app.window(), &w, &h);
 
-        font_ = make_gl_font(bmp_font_, {float(w), float(h)});
-        auto text_size = get_text_size(font_, text_);
-        auto origin = Xyz::make_vector2(-text_size.size()[0] / 2.f,
-                                        -text_size.size()[1] / 2.f - text_size.min()[1]);
-        auto buffer = format_text(font_, text_, origin);
-        count_ = int32_t(buffer.indexes.size());
         vertex_array_ = Tungsten::generate_vertex_array();
         Tungsten::bind_vertex_array(vertex_array_);
         buffers_ = Tungsten::generate_buffers(2);
-        set_buffers(buffers_[0], buffers_[1], buffer);
-
-        Tungsten::set_texture_min_filter(GL_TEXTURE_2D, GL_LINEAR);
-        Tungsten::set_texture_mag_filter(GL_TEXTURE_2D, GL_LINEAR);
-        Tungsten::set_texture_parameter(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        Tungsten::set_texture_parameter(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-        const auto& image = font_.image();
-        auto [format, type] = get_ogl_pixel_type(image.pixel_type());
-        Tungsten::set_texture_image_2d(GL_TEXTURE_2D, 0, GL_RED,
-                                       GLsizei(image.width()),
-                                       GLsizei(image.height()),
-                                       format, type,
-                                       image.data());
 
         program_.setup();
-        Tungsten::define_vertex_attribute_pointer(
-            program_.position, 2, GL_FLOAT, false, 4 * sizeof(float), 0);
-        Tungsten::enable_vertex_attribute(program_.position);
-        Tungsten::define_vertex_attribute_pointer(
-            program_.texture_coord, 2, GL_FLOAT, false, 4 * sizeof(float),
-            2 * sizeof(float));
-        Tungsten::enable_vertex_attribute(program_.texture_coord);
-
         auto m = float(std::min(w, h));
-        auto projection = Xyz::make_frustum_matrix<float>(-1, 1, -1, 1, 1, 5)
-                          * Xyz::make_look_at_matrix(Xyz::make_vector3<float>(0, 0, 1),
-                                                  Xyz::make_vector3<float>(0, 0, 0),
-                                                  Xyz::make_vector3<float>(0, 1, 0))
-                          * Xyz::scale4<float>(float(h) / m, float(w) / m, 1.f);
-
-        program_.mvp_matrix.set(projection);
+        projection_ = Xyz::make_frustum_matrix<float>(-1, 1, -1, 1, 1, 5)
+                      * Xyz::make_look_at_matrix(Xyz::make_vector3<float>(0, 0, 1),
+                                                 Xyz::make_vector3<float>(0, 0, 0),
+                                                 Xyz::make_vector3<float>(0, 1, 0))
+                      * Xyz::scale4<float>(float(h) / m, float(w) / m, 1.f);
         program_.color.set({1.0, 1.0, 1.0, 1.0});
+
+        // The text is formatted when the font has been loaded, but the
+        // attribute pointers refer to the buffer bound now.
+        bind_buffers(0);
+        Tungsten::enable_vertex_attribute(program_.position);
+        Tungsten::enable_vertex_attribute(program_.texture_coord);
+        // Only styled text has per-vertex colors.
+        if (options_.style_runs.empty())
+            glVertexAttrib4f(program_.vertex_color, 1, 1, 1, 1);
+        else
+            Tungsten::enable_vertex_attribute(program_.vertex_color);
     }
 
     bool on_event(Tungsten::SdlApplication& app, const SDL_Event& event) override
@@ -112,14 +107,11 @@ public:
         {
             glViewport(0, 0, event.window.data1, event.window.data2);
 
-            auto [w, h] = app.window_size();
-            font_ = make_gl_font(std::move(bmp_font_), {float(w), float(h)});
-            auto text_size = get_text_size(font_, text_);
-            auto origin = Xyz::make_vector2(-text_size.size()[0] / 2.f,
-                                            -text_size.size()[1] / 2.f - text_size.min()[1]);
-            auto buffer = format_text(font_, text_, origin);
-            count_ = int32_t(buffer.indexes.size());
-            set_buffers(buffers_[0], buffers_[1], buffer);
+            if (bmp_font_)
+            {
+                auto [w, h] = app.window_size();
+                update_text(w, h);
+            }
         }
 
         return EventLoop::on_event(app, event);
@@ -127,18 +119,250 @@ public:
 
     void on_draw(Tungsten::SdlApplication& app) override
     {
+        if (!bmp_font_ && is_ready(pending_bmp_font_))
+        {
+            auto loaded_font = pending_bmp_font_.get();
+            bmp_font_ = std::move(loaded_font.bitmap_font);
+            shaped_text_ = std::move(loaded_font.shaped_text);
+            font_key_ = std::move(loaded_font.font_key);
+            auto [w, h] = app.window_size();
+            update_text(w, h);
+            font_texture_ = registry_->get_texture(font_key_, bmp_font_);
+            record_memory_usage();
+        }
+
+        if (font_texture_ && !texture_ready_)
+        {
+            texture_ready_ = font_texture_->update();
+            record_memory_usage();
+            if (texture_ready_)
+            {
+                trace::add_span("time_to_text",
+                                trace::to_trace_time(options_.start_time),
+                                trace::now());
+                if (options_.print_timing)
+                    print_elapsed_time("Time to text");
+                on_texture_uploaded();
+            }
+        }
+
         glClearColor(0, 0, 0, 1);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        Tungsten::draw_triangle_elements_16(0, count_);
+        if (texture_ready_ && !counts_.empty())
+        {
+            font_texture_->bind();
+            for (size_t i = 0; i < counts_.size(); ++i)
+            {
+                if (counts_.size() > 1)
+                    bind_buffers(i);
+                Tungsten::draw_triangle_elements_16(0, counts_[i]);
+            }
+        }
+
+        if (!first_frame_drawn_)
+        {
+            trace::add_span("time_to_first_frame",
+                            trace::to_trace_time(options_.start_time),
+                            trace::now());
+            if (options_.print_timing)
+                print_elapsed_time("Time to first frame");
+        }
+        first_frame_drawn_ = true;
     }
 private:
+    static bool is_ready(const std::future<LoadedFont>& future)
+    {
+        return future.valid()
+               && future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    /**
+     * @brief Binds the vertex and index buffers of the @a i'th part of
+     *  the text and points the vertex attributes at them.
+     */
+    void bind_buffers(size_t i)
+    {
+        Tungsten::bind_buffer(GL_ARRAY_BUFFER, buffers_[2 * i]);
+        Tungsten::bind_buffer(GL_ELEMENT_ARRAY_BUFFER, buffers_[2 * i + 1]);
+        if (!options_.style_runs.empty())
+        {
+            Tungsten::define_vertex_attribute_pointer(
+                program_.position, 2, GL_FLOAT, false,
+                sizeof(StyledTextVertex), 0);
+            Tungsten::define_vertex_attribute_pointer(
+                program_.texture_coord, 2, GL_FLOAT, false,
+                sizeof(StyledTextVertex), 2 * sizeof(float));
+            Tungsten::define_vertex_attribute_pointer(
+                program_.vertex_color, 4, GL_FLOAT, false,
+                sizeof(StyledTextVertex), 4 * sizeof(float));
+        }
+        else if (options_.packed_vertexes)
+        {
+            Tungsten::define_vertex_attribute_pointer(
+                program_.position, 2, GL_SHORT, false,
+                sizeof(PackedTextVertex), 0);
+            Tungsten::define_vertex_attribute_pointer(
+                program_.texture_coord, 2, GL_UNSIGNED_SHORT, true,
+                sizeof(PackedTextVertex), 2 * sizeof(int16_t));
+        }
+        else
+        {
+            Tungsten::define_vertex_attribute_pointer(
+                program_.position, 2, GL_FLOAT, false, 4 * sizeof(float), 0);
+            Tungsten::define_vertex_attribute_pointer(
+                program_.texture_coord, 2, GL_FLOAT, false, 4 * sizeof(float),
+                2 * sizeof(float));
+        }
+    }
+
+    /**
+     * @brief Uploads each of @a buffers to its own pair of GL buffers.
+     *
+     * Buffers have 16-bit indexes, long texts are therefore split
+     * into several buffers that are drawn one at a time.
+     */
+    template <typename Vertex>
+    void set_text_buffers(std::span<const Tungsten::ArrayBuffer<Vertex>> buffers)
+    {
+        const auto count = std::max<size_t>(buffers.size(), 1);
+        while (buffers_.size() < 2 * count)
+        {
+            for (auto& buffer : Tungsten::generate_buffers(2))
+                buffers_.push_back(std::move(buffer));
+        }
+        buffers_.erase(buffers_.begin() + ptrdiff_t(2 * count), buffers_.end());
+
+        counts_.clear();
+        vertex_buffer_size_ = 0;
+        index_buffer_size_ = 0;
+        for (size_t i = 0; i < buffers.size(); ++i)
+        {
+            set_buffers(buffers_[2 * i], buffers_[2 * i + 1], buffers[i]);
+            counts_.push_back(int32_t(buffers[i].indexes.size()));
+            vertex_buffer_size_ += buffers[i].vertexes.size() * sizeof(Vertex);
+            index_buffer_size_ += buffers[i].indexes.size() * sizeof(uint16_t);
+        }
+        if (counts_.size() == 1)
+            bind_buffers(0);
+    }
+
+    void print_elapsed_time(std::string_view label) const
+    {
+        using namespace std::chrono;
+        auto elapsed = duration_cast<milliseconds>(Clock::now() - options_.start_time);
+        std::cout << label << ": " << elapsed.count() << " ms\n";
+    }
+
+    MemoryUsage memory_usage() const
+    {
+        MemoryUsage usage;
+        if (bmp_font_)
+            usage += get_memory_usage(*bmp_font_);
+        usage += get_memory_usage(font_);
+        usage.gpu_buffers = vertex_buffer_size_ + index_buffer_size_;
+        if (font_texture_)
+        {
+            usage.gpu_buffers += font_texture_->buffer_memory_usage();
+            usage.gpu_textures = font_texture_->texture_memory_usage();
+        }
+        return usage;
+    }
+
+    void record_memory_usage()
+    {
+        auto usage = memory_usage();
+        if (usage.total() > peak_memory_usage_.total())
+            peak_memory_usage_ = usage;
+    }
+
+    void on_texture_uploaded()
+    {
+        if (options_.release_image)
+            bmp_font_->release_image();
+
+        if (options_.print_stats)
+        {
+            std::cout << "Peak memory usage:\n" << peak_memory_usage_
+                      << "Memory usage after startup:\n" << memory_usage()
+                      << "The atlas image is "
+                      << (options_.release_image ? "released" : "kept")
+                      << " after upload, it is only needed if the texture"
+                         " must be uploaded again.\n";
+        }
+    }
+
+    void update_text(int w, int h)
+    {
+        SHOWTEXT_TRACE_SCOPE("update_text");
+        font_ = make_gl_font(bmp_font_, {float(w), float(h)});
+        auto text_size = shaped_text_
+                         ? get_shaped_text_size(font_, *shaped_text_)
+                         : get_text_size(font_, text_);
+        auto origin = Xyz::make_vector2(-text_size.size()[0] / 2.f,
+                                        -text_size.size()[1] / 2.f - text_size.min()[1]);
+        if (shaped_text_)
+        {
+            auto buffer = format_shaped_text(font_, *shaped_text_, origin);
+            set_text_buffers<TextVertex>(std::span(&buffer, 1));
+            program_.mvp_matrix.set(projection_);
+        }
+        else if (!options_.style_runs.empty())
+        {
+            auto buffer = format_styled_text(font_, text_, options_.style_runs,
+                                             origin);
+            set_text_buffers<StyledTextVertex>(std::span(&buffer, 1));
+            program_.mvp_matrix.set(projection_);
+        }
+        else if (options_.packed_vertexes)
+        {
+            auto buffers = format_packed_text_parallel(font_, text_, origin,
+                                                       options_.layout_threads);
+            if (options_.verify_packed_vertexes)
+                verify_packed_text(origin);
+            set_text_buffers<PackedTextVertex>(buffers);
+            auto scale = get_packed_position_scale(font_);
+            program_.mvp_matrix.set(projection_
+                                    * Xyz::scale4<float>(scale[0], scale[1], 1.f));
+        }
+        else
+        {
+            auto buffers = format_text_parallel(font_, text_, origin,
+                                                options_.layout_threads);
+            set_text_buffers<TextVertex>(buffers);
+            program_.mvp_matrix.set(projection_);
+        }
+    }
+
+    void verify_packed_text(const Xyz::Vector2F& origin) const
+    {
+        const auto error = get_max_packed_error(font_, text_, origin);
+        std::cout << "Largest difference between packed and float vertexes: "
+                  << error << " pixels\n";
+        // Allow for the rounding error of the float vertexes.
+        if (error > 1.f / 8 + 1.f / 1024)
+            throw std::runtime_error("The packed vertexes are off by more than 1/8 pixel.");
+    }
+
+    std::shared_ptr<FontRegistry> registry_;
+    FontKey font_key_;
+    std::future<LoadedFont> pending_bmp_font_;
     std::shared_ptr<BitmapFont> bmp_font_;
+    std::shared_ptr<const std::vector<ShapedGlyph>> shaped_text_;
     GlFont font_;
     std::u32string text_;
+    ShowTextOptions options_;
+    bool first_frame_drawn_ = false;
     std::vector<Tungsten::BufferHandle> buffers_;
     Tungsten::VertexArrayHandle vertex_array_;
+    std::shared_ptr<FontTexture> font_texture_;
+    bool texture_ready_ = false;
     ShowTextShaderProgram program_;
-    int32_t count_ = 0;
+    Xyz::Matrix4F projection_;
+    // The number of indexes in each pair of buffers.
+    std::vector<int32_t> counts_;
+    size_t vertex_buffer_size_ = 0;
+    size_t index_buffer_size_ = 0;
+    MemoryUsage peak_memory_usage_;
 };
 
 argos::ParsedArguments parse_arguments(int argc, char* argv[])
@@ -154,7 +378,53 @@ argos::ParsedArguments parse_arguments(int argc, char* argv[])
                        " PNG file, the JSON file, or just the font name"
                        " without the extension."))
         .add(argos::Option{"-f", "--font"}.argument("FILE:SIZE")
-                 .help("Path to a font (e.g. the .ttf file) and the size."));
+                 .help("Path to a font (e.g. the .ttf file) and the size."
+                       " The built-in font is used if neither this option"
+                       " nor --bmpfont is given, provided ShowText was"
+                       " built with one."))
+        .add(argos::Option{"--fallback"}.argument("FILE")
+                 .operation(argos::OptionOperation::APPEND)
+                 .help("A font that is used for characters the --font font"
+                       " doesn't have. The option can be repeated, the"
+                       " fonts are searched in the given order."))
+        .add(argos::Option{"--packed"}
+                 .help("Use vertexes with 16-bit integer coordinates"
+                       " instead of 32-bit floats. Positions are rounded"
+                       " to the nearest quarter pixel and must be within"
+                       " 8191 pixels of the window's center."))
+        .add(argos::Option{"--verify"}
+                 .help("Compare the packed vertexes with float vertexes and"
+                       " fail if a position differs by more than 1/8"
+                       " pixel. Requires --packed."))
+        .add(argos::Option{"--timing"}
+                 .help("Print the time until the first frame and the time"
+                       " until the text is displayed."))
+        .add(argos::Option{"--stats"}
+                 .help("Print how much memory is used by the font, the"
+                       " atlas and the GL buffers and textures."))
+        .add(argos::Option{"--release-image"}
+                 .help("Release the CPU copy of the atlas image when it"
+                       " has been uploaded to the GL."))
+        .add(argos::Option{"--style"}.argument("FIRST:LAST:COLOR[:us]")
+                 .operation(argos::OptionOperation::APPEND)
+                 .help("Draw the characters from index FIRST to LAST with"
+                       " the hexadecimal RRGGBB or RRGGBBAA color COLOR. Add"
+                       " u to underline the characters, s to strike them"
+                       " through. The option can be repeated, but the"
+                       " ranges can't overlap. Can't be combined with"
+                       " --packed."))
+        .add(argos::Option{"--trace"}.argument("FILE")
+                 .help("Write a trace of the program's startup to FILE."
+                       " The trace can be opened in chrome://tracing or"
+                       " https://ui.perfetto.dev."))
+        .add(argos::Option{"-j", "--threads"}.argument("N")
+                 .help("Lay out the text with N threads. 0 uses one thread"
+                       " per core. The default is 1."));
+#ifdef SHOWTEXT_USE_HARFBUZZ
+    parser.add(argos::Option{"--shape"}
+                   .help("Shape the text with HarfBuzz. Requires --font and"
+                         " can't be combined with --packed."));
+#endif
     Tungsten::SdlApplication::add_command_line_options(parser);
     return parser.parse(argc, argv);
 }
@@ -164,44 +434,260 @@ std::vector<char32_t> get_unique_chars(std::u32string_view str)
     std::unordered_set<char32_t> chars;
     for (auto ch : str)
         chars.insert(ch);
-    return {chars.begin(), chars.end()};
+    std::vector<char32_t> result(chars.begin(), chars.end());
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+Xyz::Vector4F parse_color(const argos::ArgumentValue& arg)
+{
+    auto str = arg.as_string();
+    uint32_t rgba = 0;
+    auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(),
+                                     rgba, 16);
+    if (ec != std::errc() || ptr != str.data() + str.size()
+        || (str.size() != 6 && str.size() != 8))
+    {
+        arg.error("Invalid color: " + str);
+    }
+    if (str.size() == 6)
+        rgba = (rgba << 8u) | 0xFFu;
+    return {float((rgba >> 24u) & 0xFFu) / 255.f,
+            float((rgba >> 16u) & 0xFFu) / 255.f,
+            float((rgba >> 8u) & 0xFFu) / 255.f,
+            float(rgba & 0xFFu) / 255.f};
+}
+
+std::vector<StyleRun> get_style_runs(const argos::ParsedArguments& args)
+{
+    std::vector<StyleRun> runs;
+    for (const auto& value : args.values("--style").values())
+    {
+        auto parts = value.split(':', 3, 4);
+        StyleRun run;
+        run.begin = parts.value(0).as_uint();
+        run.end = size_t(parts.value(1).as_uint()) + 1;
+        if (run.end <= run.begin)
+            value.error("LAST can't be less than FIRST.");
+        run.style.color = parse_color(parts.value(2));
+        const auto decorations = parts.size() == 4
+                                 ? parts.value(3).as_string()
+                                 : std::string();
+        for (auto c : decorations)
+        {
+            if (c == 'u')
+                run.style.underline = true;
+            else if (c == 's')
+                run.style.strikethrough = true;
+            else
+                value.error("Invalid decoration: " + std::string(1, c));
+        }
+        runs.push_back(run);
+    }
+
+    std::sort(runs.begin(), runs.end(),
+              [](auto& a, auto& b) {return a.begin < b.begin;});
+    for (size_t i = 1; i < runs.size(); ++i)
+    {
+        if (runs[i].begin < runs[i - 1].end)
+            args.error("The --style ranges overlap.");
+    }
+    return runs;
 }
 
+struct FontSource
+{
+    FontKey key;
+    std::function<BitmapFont()> load;
+};
+
+FontSource get_font_source(const argos::ParsedArguments& args,
+                           std::vector<char32_t> chars)
+{
+    if (auto bmp_font_arg = args.value("--bmpfont"))
+    {
+        auto path = bmp_font_arg.as_string();
+        return {{path, 0, FontMode::BITMAP_FONT},
+                [path]
+                {
+                    return read_bitmap_font(path);
+                }};
+    }
+
+    if (auto font_arg = args.value("--font"))
+    {
+        auto parts = font_arg.split(':', 2, 2);
+        auto path = parts.value(0).as_string();
+        auto size = parts.value(1).as_uint();
+        auto fallbacks = args.values("--fallback").as_strings();
+        std::u32string key_chars(chars.begin(), chars.end());
+        if (fallbacks.empty())
+        {
+            return {{path, size, FontMode::RASTERIZED, std::move(key_chars)},
+                    [path, size, chars = std::move(chars)]() mutable
+                    {
+                        return make_bitmap_font(path, size, chars);
+                    }};
+        }
+
+        fallbacks.insert(fallbacks.begin(), path);
+        auto key_path = ystring::join(fallbacks.begin(), fallbacks.end(), ";");
+        return {{key_path, size, FontMode::RASTERIZED, std::move(key_chars)},
+                [paths = std::move(fallbacks), size, chars = std::move(chars)]() mutable
+                {
+                    return make_bitmap_font(paths, size, chars);
+                }};
+    }
+
+#ifdef SHOWTEXT_HAS_DEFAULT_FONT
+    return {{"DefaultFont", 0, FontMode::EMBEDDED},
+            []
+            {
+                return make_bitmap_font(DefaultFont);
+            }};
+#else
+    args.error("No font was specified.");
+#endif
+}
+
+#ifdef SHOWTEXT_USE_HARFBUZZ
+/**
+ * @brief Shapes @a text one line at a time so that repeated lines are
+ *  found in the shaper's cache.
+ *
+ * Lines are the smallest unit that can be shaped on its own: a line's
+ * words depend on each other's direction and can form ligatures and
+ * kerning pairs across spaces.
+ */
+std::shared_ptr<const std::vector<ShapedGlyph>>
+shape_lines(TextShaper& shaper, std::u32string_view text)
+{
+    auto result = std::make_shared<std::vector<ShapedGlyph>>();
+    size_t begin = 0;
+    while (begin < text.size())
+    {
+        auto end = text.find(U'\n', begin);
+        end = end == std::u32string_view::npos ? text.size() : end + 1;
+        auto run = shaper.shape(text.substr(begin, end - begin));
+        for (auto glyph : *run)
+        {
+            glyph.cluster += uint32_t(begin);
+            result->push_back(glyph);
+        }
+        begin = end;
+    }
+    return result;
+}
+
+LoadedFont load_shaped_font(FontRegistry& registry,
+                            std::shared_ptr<ShapedRunCache> cache,
+                            const FontKey& key,
+                            std::u32string_view text,
+                            bool print_statistics)
+{
+    TextShaper shaper(key.path, key.size, std::move(cache));
+    auto shaped_text = shape_lines(shaper, text);
+    std::u32string glyphs;
+    for (const auto& glyph : *shaped_text)
+        glyphs.push_back(glyph.glyph_index);
+    std::sort(glyphs.begin(), glyphs.end());
+    glyphs.erase(std::unique(glyphs.begin(), glyphs.end()), glyphs.end());
+
+    FontKey shaped_key{key.path, key.size, FontMode::SHAPED, glyphs};
+    auto font = registry.get_bitmap_font(
+        shaped_key,
+        [&]
+        {
+            return make_glyph_bitmap_font(key.path, key.size, glyphs);
+        });
+    if (print_statistics)
+        std::cout << shaper.cache()->statistics();
+    return {std::move(font), std::move(shaped_text), std::move(shaped_key)};
+}
+#endif
+
 int main(int argc, char* argv[])
 {
+    auto start_time = Clock::now();
     try
     {
         auto args = parse_arguments(argc, argv);
+        auto trace_file = args.value("--trace").as_string();
+        if (!trace_file.empty())
+        {
+            trace::enable();
+            trace::add_span("parse_arguments",
+                            trace::to_trace_time(start_time), trace::now());
+        }
+
         auto texts = args.values("TEXT").as_strings();
         auto text8 = ystring::join(texts.begin(), texts.end(), " ");
+        trace::Span utf32_span("to_utf32");
         auto text32 = ystring::to_utf32(text8);
+        utf32_span.end();
+        trace::Span chars_span("get_unique_chars");
         auto chars = get_unique_chars(text32);
+        chars_span.end();
 
-        auto bmp_font = std::make_shared<BitmapFont>();
-        if (auto bmp_font_arg = args.value("--bmpfont"))
-        {
-            *bmp_font = read_bitmap_font(bmp_font_arg.as_string());
-        }
-        else if (auto font_arg = args.value("--font"))
+        auto registry = std::make_shared<FontRegistry>();
+        auto font_source = get_font_source(args, std::move(chars));
+        ShowTextOptions options;
+        options.packed_vertexes = args.value("--packed").as_bool();
+        options.verify_packed_vertexes = args.value("--verify").as_bool();
+        if (options.verify_packed_vertexes && !options.packed_vertexes)
+            args.error("--verify requires --packed.");
+        options.print_timing = args.value("--timing").as_bool();
+        options.print_stats = args.value("--stats").as_bool();
+        options.release_image = args.value("--release-image").as_bool();
+        options.layout_threads = args.value("--threads").as_uint(1);
+        options.style_runs = get_style_runs(args);
+        if (!options.style_runs.empty() && options.packed_vertexes)
+            args.error("--style can't be combined with --packed.");
+        options.start_time = start_time;
+
+        [[maybe_unused]] bool shape_text = false;
+#ifdef SHOWTEXT_USE_HARFBUZZ
+        auto shaping_cache = std::make_shared<ShapedRunCache>();
+        if (args.value("--shape").as_bool())
         {
-            auto parts = font_arg.split(':', 2, 2);
-            *bmp_font = make_bitmap_font(parts.value(0).as_string(),
-                                         parts.value(1).as_uint(),
-                                         chars);
+            if (font_source.key.mode != FontMode::RASTERIZED)
+                args.error("--shape requires --font.");
+            if (options.packed_vertexes)
+                args.error("--shape can't be combined with --packed.");
+            if (!args.values("--fallback").as_strings().empty())
+                args.error("--shape can't be combined with --fallback.");
+            if (!options.style_runs.empty())
+                args.error("--shape can't be combined with --style.");
+            shape_text = true;
         }
-        else
+#endif
+
+        auto bmp_font = std::async(std::launch::async, [=]() -> LoadedFont
         {
-            args.error("No font was specified.");
-        }
+            SHOWTEXT_TRACE_SCOPE("load_font");
+#ifdef SHOWTEXT_USE_HARFBUZZ
+            if (shape_text)
+            {
+                return load_shaped_font(*registry, shaping_cache,
+                                        font_source.key, text32,
+                                        options.print_timing);
+            }
+#endif
+            return {registry->get_bitmap_font(font_source.key, font_source.load),
+                    {}, font_source.key};
+        });
 
-        auto event_loop = std::make_unique<ShowText>(
-            std::move(bmp_font),
-            text32);
+        auto event_loop = std::make_unique<ShowText>(registry,
+                                                     std::move(bmp_font),
+                                                     text32,
+                                                     options);
         Tungsten::SdlApplication app("ShowPng", std::move(event_loop));
         auto params = app.window_parameters();
         params.gl_parameters.multi_sampling = {1, 2};
         app.read_command_line_options(args);
         app.run();
+        if (!trace_file.empty())
+            trace::write(trace_file);
     }
     catch (std::exception& ex)
     {
@@ -0,0 +1,156 @@
+//****************************************************************************
+// Copyright © 2026 Jan Erik Breimo. All rights reserved.
+// Created by Jan Erik Breimo on 2026-10-19.
+//
+// This file is distributed under the BSD License.
+// License text is included with the source distribution.
+//****************************************************************************
+#include "Manifest.hpp"
+
+#include <filesystem>
+#include <set>
+#include <stdexcept>
+#include <Yson/JsonReader.hpp>
+#include <Yson/ReaderIterators.hpp>
+#include <Ystring/Ystring.hpp>
+
+std::pair<char32_t, char32_t> parse_char_range(const std::string& range)
+{
+    auto dash = range.find('-', 1);
+    if (dash == std::string::npos)
+        throw std::runtime_error("Invalid range: " + range);
+    auto first = std::stoul(range.substr(0, dash), nullptr, 0);
+    auto last = std::stoul(range.substr(dash + 1), nullptr, 0);
+    if (first > last || last > 0x10FFFF)
+        throw std::runtime_error("Invalid range: " + range);
+    return {char32_t(first), char32_t(last)};
+}
+
+namespace
+{
+    std::string replace_size(std::string str, unsigned size)
+    {
+        const std::string_view placeholder = "{size}";
+        const auto size_str = std::to_string(size);
+        for (auto pos = str.find(placeholder); pos != std::string::npos;
+             pos = str.find(placeholder, pos + size_str.size()))
+        {
+            str.replace(pos, placeholder.size(), size_str);
+        }
+        return str;
+    }
+
+    std::string get_path(const std::filesystem::path& dir,
+                         const std::string& path)
+    {
+        return (dir / std::filesystem::path(path)).lexically_normal().string();
+    }
+
+    template <typename Item>
+    std::vector<std::string> get_strings(const Item& item)
+    {
+        std::vector<std::string> result;
+        for (const auto& value : item.array())
+            result.push_back(Yson::get<std::string>(value));
+        return result;
+    }
+
+    template <typename Item>
+    std::vector<BakeJob> read_job(const Item& item,
+                                  const std::filesystem::path& dir)
+    {
+        std::vector<std::string> font_paths(1);
+        std::vector<unsigned> sizes;
+        std::set<char32_t> chars;
+        std::vector<std::string> outputs;
+        std::string name = "DefaultFont";
+        for (const auto& [key, value] : item.object())
+        {
+            if (key == "font")
+            {
+                font_paths[0] = get_path(dir, Yson::get<std::string>(value));
+            }
+            else if (key == "fallback")
+            {
+                for (const auto& path : get_strings(value))
+                    font_paths.push_back(get_path(dir, path));
+            }
+            else if (key == "sizes")
+            {
+                for (const auto& size : value.array())
+                    sizes.push_back(Yson::get<unsigned>(size));
+            }
+            else if (key == "chars")
+            {
+                for (auto ch : ystring::to_utf32(Yson::get<std::string>(value)))
+                    chars.insert(ch);
+            }
+            else if (key == "ranges")
+            {
+                for (const auto& range : get_strings(value))
+                {
+                    auto [first, last] = parse_char_range(range);
+                    for (auto ch = first; ch <= last; ++ch)
+                        chars.insert(ch);
+                }
+            }
+            else if (key == "outputs")
+            {
+                outputs = get_strings(value);
+            }
+            else if (key == "name")
+            {
+                name = Yson::get<std::string>(value);
+            }
+            else
+            {
+                throw std::runtime_error("Unknown key in bake job: " + key);
+            }
+        }
+
+        if (font_paths[0].empty())
+            throw std::runtime_error("A bake job has no \"font\".");
+        if (sizes.empty())
+            throw std::runtime_error("A bake job has no \"sizes\".");
+        if (outputs.empty())
+            throw std::runtime_error("A bake job has no \"outputs\".");
+        if (chars.empty())
+        {
+            for (char32_t ch = 32; ch <= 126; ++ch)
+                chars.insert(ch);
+        }
+
+        std::vector<BakeJob> jobs;
+        for (auto size : sizes)
+        {
+            BakeJob& job = jobs.emplace_back();
+            job.font_paths = font_paths;
+            job.size = size;
+            job.chars.assign(chars.begin(), chars.end());
+            for (const auto& output : outputs)
+                job.outputs.push_back(get_path(dir, replace_size(output, size)));
+            job.name = replace_size(name, size);
+        }
+        return jobs;
+    }
+}
+
+std::vector<BakeJob> read_manifest(const std::string& path)
+{
+    const auto dir = std::filesystem::path(path).parent_path();
+    Yson::JsonReader reader(path);
+    std::vector<BakeJob> result;
+    for (const auto& key : keys(reader))
+    {
+        if (key != "jobs")
+            throw std::runtime_error("Unknown key in " + path + ": " + key);
+
+        auto jobs = reader.readItem();
+        for (const auto& item : jobs.array())
+        {
+            for (auto& job : read_job(item, dir))
+                result.push_back(std::move(job));
+        }
+    }
+    return result;
+}
@@ -0,0 +1,58 @@
+//****************************************************************************
+// Copyright © 2026 Jan Erik Breimo. All rights reserved.
+// Created by Jan Erik Breimo on 2026-10-19.
+//
+// This file is distributed under the BSD License.
+// License text is included with the source distribution.
+//****************************************************************************
+#pragma once
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief One font and size that is baked to one or more outputs.
+ */
+struct BakeJob
+{
+    // The main font followed by its fallback fonts.
+    std::vector<std::string> font_paths;
+    unsigned size = 0;
+    std::vector<char32_t> chars;
+    // C++ headers or PNG and JSON base names, see ShowTextBake's OUTPUT.
+    std::vector<std::string> outputs;
+    std::string name;
+};
+
+/**
+ * @brief Returns the range of code points in "FIRST-LAST", the numbers
+ *  can be decimal or hexadecimal with a 0x prefix.
+ */
+std::pair<char32_t, char32_t> parse_char_range(const std::string& range);
+
+/**
+ * @brief Reads a bake manifest and returns one job per font and size.
+ *
+ * The manifest looks like this:
+ *
+ *     {
+ *       "jobs": [
+ *         {
+ *           "font": "fonts/Lato-Regular.ttf",
+ *           "fallback": ["fonts/NotoSansSymbols.ttf"],
+ *           "sizes": [12, 16, 24],
+ *           "chars": "€…",
+ *           "ranges": ["32-126", "0xA0-0xFF"],
+ *           "outputs": ["gen/Lato{size}.hpp", "fonts/Lato{size}"],
+ *           "name": "Lato{size}"
+ *         }
+ *       ]
+ *     }
+ *
+ * "fallback", "chars", "ranges" and "name" are optional, the charset
+ * defaults to 32-126 and the name to DefaultFont. {size} in "outputs"
+ * and "name" is replaced by the size. Relative paths are relative to
+ * the manifest's directory.
+ */
+std::vector<BakeJob> read_manifest(const std::string& path);
@@ -0,0 +1,77 @@
+//****************************************************************************
+// Copyright © 2026 Jan Erik Breimo. All rights reserved.
+// Created by Jan Erik Breimo on 2026-10-19.
+//
+// This file is distributed under the BSD License.
+// License text is included with the source distribution.
+//****************************************************************************
+#include "WorkStealingPool.hpp"
+
+#include <algorithm>
+#include <thread>
+
+WorkStealingPool::WorkStealingPool(unsigned thread_count)
+{
+    if (thread_count == 0)
+        thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+    for (unsigned i = 0; i < thread_count; ++i)
+        queues_.push_back(std::make_unique<Queue>());
+}
+
+unsigned WorkStealingPool::thread_count() const
+{
+    return unsigned(queues_.size());
+}
+
+void WorkStealingPool::add(unsigned worker, Task task)
+{
+    auto& queue = *queues_[worker % queues_.size()];
+    std::lock_guard lock(queue.mutex);
+    queue.tasks.push_back(std::move(task));
+}
+
+void WorkStealingPool::run()
+{
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < thread_count(); ++i)
+        threads.emplace_back([this, i] {run_worker(i);});
+    run_worker(0);
+    for (auto& thread : threads)
+        thread.join();
+}
+
+bool WorkStealingPool::pop(unsigned worker, Task& task)
+{
+    auto& queue = *queues_[worker];
+    std::lock_guard lock(queue.mutex);
+    if (queue.tasks.empty())
+        return false;
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::steal(unsigned worker, Task& task)
+{
+    for (unsigned i = 1; i < thread_count(); ++i)
+    {
+        auto& queue = *queues_[(worker + i) % thread_count()];
+        std::lock_guard lock(queue.mutex);
+        if (!queue.tasks.empty())
+        {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::run_worker(unsigned worker)
+{
+    // Tasks don't add new tasks, a worker can therefore stop as soon as
+    // every queue is empty.
+    Task task;
+    while (pop(worker, task) || steal(worker, task))
+        task(worker);
+}
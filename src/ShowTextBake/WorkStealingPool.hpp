@@ -0,0 +1,58 @@
+//****************************************************************************
+// Copyright © 2026 Jan Erik Breimo. All rights reserved.
+// Created by Jan Erik Breimo on 2026-10-19.
+//
+// This file is distributed under the BSD License.
+// License text is included with the source distribution.
+//****************************************************************************
+#pragma once
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Runs tasks on a fixed number of threads, threads that run out
+ *  of tasks steal them from the others.
+ *
+ * A worker takes tasks from the back of its own queue and steals from
+ * the front of the other workers' queues. Tasks that share state, e.g.
+ * an open font face, should therefore be added to the same worker.
+ */
+class WorkStealingPool
+{
+public:
+    using Task = std::function<void(unsigned worker)>;
+
+    /**
+     * @brief A @a thread_count of 0 creates one worker per core.
+     */
+    explicit WorkStealingPool(unsigned thread_count = 0);
+
+    [[nodiscard]]
+    unsigned thread_count() const;
+
+    void add(unsigned worker, Task task);
+
+    /**
+     * @brief Runs all tasks and returns when they have finished.
+     *
+     * The tasks must not throw.
+     */
+    void run();
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    bool pop(unsigned worker, Task& task);
+
+    bool steal(unsigned worker, Task& task);
+
+    void run_worker(unsigned worker);
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+};
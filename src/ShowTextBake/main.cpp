@@ -0,0 +1,355 @@
+//****************************************************************************
+// Copyright © 2026 Jan Erik Breimo. All rights reserved.
+// Created by Jan Erik Breimo on 2026-10-19.
+//
+// This file is distributed under the BSD License.
+// License text is included with the source distribution.
+//****************************************************************************
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <set>
+#include <Argos/Argos.hpp>
+#include <Ystring/Ystring.hpp>
+#include "BitmapFont.hpp"
+#include "EmbeddedFont.hpp"
+#include "Manifest.hpp"
+#include "Trace.hpp"
+#include "WorkStealingPool.hpp"
+
+argos::ParsedArguments parse_arguments(int argc, char* argv[])
+{
+    argos::ArgumentParser parser(argv[0]);
+    parser.about("Creates a bitmap font from a font file. The bitmap font"
+                 " is written either as a PNG and a JSON file, or as a C++"
+                 " header that can be compiled into a program. With"
+                 " --manifest, all the fonts listed in a manifest file"
+                 " are created instead.")
+        .add(argos::Argument("FONT").count(0, 1)
+                 .help("Path to a font (e.g. the .ttf file)."))
+        .add(argos::Argument("SIZE").count(0, 1)
+                 .help("The font size in pixels."))
+        .add(argos::Argument("OUTPUT").count(0, 1)
+                 .help("The output file. A C++ header is written if the"
+                       " file name ends with .hpp or .h, otherwise the"
+                       " PNG and JSON files OUTPUT.png and OUTPUT.json"
+                       " are written."))
+        .add(argos::Option{"-m", "--manifest"}.argument("FILE")
+                 .help("A JSON file that lists fonts, sizes, characters"
+                       " and outputs, see src/ShowTextBake/Manifest.hpp."
+                       " FONT, SIZE and OUTPUT can't be given with this"
+                       " option. Outputs that are newer than their fonts"
+                       " and the manifest are skipped."))
+        .add(argos::Option{"-f", "--force"}
+                 .help("Bake all the fonts in the manifest, also those"
+                       " that are up to date."))
+        .add(argos::Option{"-j", "--threads"}.argument("N")
+                 .help("The number of threads used for --manifest. The"
+                       " default is one thread per core."))
+        .add(argos::Option{"-c", "--chars"}.argument("TEXT")
+                 .operation(argos::OptionOperation::APPEND)
+                 .help("Characters to include in the bitmap font."))
+        .add(argos::Option{"-r", "--range"}.argument("FIRST-LAST")
+                 .operation(argos::OptionOperation::APPEND)
+                 .help("A range of code points to include in the bitmap"
+                       " font. The numbers can be decimal or hexadecimal"
+                       " with a 0x prefix. The default is 32-126 if"
+                       " neither --chars nor --range is given."))
+        .add(argos::Option{"-n", "--name"}.argument("NAME")
+                 .help("The name of the font variable in the C++ header."
+                       " The default is DefaultFont."))
+        .add(argos::Option{"--trace"}.argument("FILE")
+                 .help("Write a trace of the bake to FILE. The trace can"
+                       " be opened in chrome://tracing or"
+                       " https://ui.perfetto.dev."));
+    return parser.parse(argc, argv);
+}
+
+std::vector<char32_t> get_chars(const argos::ParsedArguments& args)
+{
+    std::set<char32_t> chars;
+    for (const auto& text : args.values("--chars").as_strings())
+    {
+        for (auto ch : ystring::to_utf32(text))
+            chars.insert(ch);
+    }
+
+    for (const auto& value : args.values("--range").values())
+    {
+        std::pair<char32_t, char32_t> range;
+        try
+        {
+            range = parse_char_range(value.as_string());
+        }
+        catch (std::exception&)
+        {
+            value.error("invalid range.");
+        }
+        for (auto ch = range.first; ch <= range.second; ++ch)
+            chars.insert(ch);
+    }
+
+    if (chars.empty())
+    {
+        for (char32_t ch = 32; ch <= 126; ++ch)
+            chars.insert(ch);
+    }
+
+    return {chars.begin(), chars.end()};
+}
+
+bool is_header_file(const std::string& file_name)
+{
+    auto name = ystring::to_lower(file_name);
+    return name.ends_with(".hpp") || name.ends_with(".h");
+}
+
+void write_outputs(const BitmapFont& font,
+                   const std::vector<std::string>& outputs,
+                   const std::string& name)
+{
+    for (const auto& output : outputs)
+    {
+        if (is_header_file(output))
+            write_embedded_font(font, name, output);
+        else
+            write_font(font, output);
+    }
+}
+
+std::vector<std::string> get_output_files(const std::string& output)
+{
+    if (is_header_file(output))
+        return {output};
+    return {output + ".json", output + ".png"};
+}
+
+bool is_up_to_date(const BakeJob& job, const std::string& manifest_path)
+{
+    namespace fs = std::filesystem;
+    auto newest_input = fs::last_write_time(manifest_path);
+    for (const auto& path : job.font_paths)
+        newest_input = std::max(newest_input, fs::last_write_time(path));
+
+    for (const auto& output : job.outputs)
+    {
+        for (const auto& file : get_output_files(output))
+        {
+            std::error_code ec;
+            auto time = fs::last_write_time(file, ec);
+            if (ec || time < newest_input)
+                return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief The faces a worker has opened, jobs for the same font file
+ *  reuse them.
+ */
+class WorkerFaces
+{
+public:
+    struct LoadedFace
+    {
+        freetype::Face face;
+        CoverageBitmap coverage;
+    };
+
+    LoadedFace& get(const std::string& path)
+    {
+        auto it = faces_.find(path);
+        if (it == faces_.end())
+        {
+            auto face = library_.new_face(path);
+            face.select_charmap(FT_ENCODING_UNICODE);
+            auto coverage = get_coverage(face);
+            it = faces_.emplace(path, LoadedFace{std::move(face),
+                                                 std::move(coverage)}).first;
+        }
+        return it->second;
+    }
+private:
+    // Declared before faces_ as the faces must be destroyed first.
+    freetype::Library library_;
+    std::map<std::string, LoadedFace> faces_;
+};
+
+struct BakeResult
+{
+    enum class Status {WAITING, BAKED, UP_TO_DATE, FAILED};
+
+    Status status = Status::WAITING;
+    std::string error;
+    double milliseconds = 0;
+    unsigned worker = 0;
+};
+
+void bake(const BakeJob& job, WorkerFaces& worker_faces)
+{
+    SHOWTEXT_TRACE_SCOPE("bake");
+    std::vector<freetype::Face*> faces;
+    std::vector<const CoverageBitmap*> coverage;
+    for (const auto& path : job.font_paths)
+    {
+        auto& loaded_face = worker_faces.get(path);
+        faces.push_back(&loaded_face.face);
+        coverage.push_back(&loaded_face.coverage);
+    }
+
+    auto chars = job.chars;
+    auto font = make_bitmap_font(faces, coverage, job.size, chars);
+    for (const auto& output : job.outputs)
+    {
+        auto dir = std::filesystem::path(output).parent_path();
+        if (!dir.empty())
+            std::filesystem::create_directories(dir);
+    }
+    write_outputs(font, job.outputs, job.name);
+}
+
+std::ostream& operator<<(std::ostream& os, BakeResult::Status status)
+{
+    switch (status)
+    {
+    case BakeResult::Status::WAITING: return os << "waiting";
+    case BakeResult::Status::BAKED: return os << "baked";
+    case BakeResult::Status::UP_TO_DATE: return os << "up to date";
+    case BakeResult::Status::FAILED: return os << "FAILED";
+    }
+    return os;
+}
+
+void print_summary(const std::vector<BakeJob>& jobs,
+                   const std::vector<BakeResult>& results,
+                   double total_milliseconds)
+{
+    size_t counts[4] = {};
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        const auto& job = jobs[i];
+        const auto& result = results[i];
+        ++counts[size_t(result.status)];
+        std::cout << std::fixed << std::setprecision(1)
+                  << std::setw(9) << result.milliseconds << " ms  "
+                  << "worker " << std::setw(2) << result.worker << "  "
+                  << std::left << std::setw(10) << result.status << std::right
+                  << "  " << std::filesystem::path(job.font_paths[0]).filename().string()
+                  << ' ' << job.size << " ->";
+        for (const auto& output : job.outputs)
+            std::cout << ' ' << output;
+        std::cout << '\n';
+        if (!result.error.empty())
+            std::cout << "    " << result.error << '\n';
+    }
+
+    using Status = BakeResult::Status;
+    std::cout << jobs.size() << " jobs: "
+              << counts[size_t(Status::BAKED)] << " baked, "
+              << counts[size_t(Status::UP_TO_DATE)] << " up to date, "
+              << counts[size_t(Status::FAILED)] << " failed in "
+              << std::fixed << std::setprecision(1) << total_milliseconds
+              << " ms.\n";
+}
+
+bool run_manifest(const std::string& manifest_path,
+                  unsigned thread_count,
+                  bool force)
+{
+    using Clock = std::chrono::steady_clock;
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+    const auto start_time = Clock::now();
+
+    const auto jobs = read_manifest(manifest_path);
+    std::vector<BakeResult> results(jobs.size());
+
+    WorkStealingPool pool(thread_count);
+    std::vector<WorkerFaces> worker_faces(pool.thread_count());
+
+    // Jobs for the same font start on the same worker to let them share
+    // the face.
+    std::map<std::string, unsigned> font_workers;
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        auto [it, _] = font_workers.emplace(jobs[i].font_paths[0],
+                                            unsigned(font_workers.size()));
+        pool.add(it->second, [&, i](unsigned worker)
+        {
+            const auto job_start = Clock::now();
+            auto& result = results[i];
+            result.worker = worker;
+            try
+            {
+                if (!force && is_up_to_date(jobs[i], manifest_path))
+                {
+                    result.status = BakeResult::Status::UP_TO_DATE;
+                }
+                else
+                {
+                    bake(jobs[i], worker_faces[worker]);
+                    result.status = BakeResult::Status::BAKED;
+                }
+            }
+            catch (std::exception& ex)
+            {
+                result.status = BakeResult::Status::FAILED;
+                result.error = ex.what();
+            }
+            result.milliseconds = Milliseconds(Clock::now() - job_start).count();
+        });
+    }
+
+    pool.run();
+
+    print_summary(jobs, results, Milliseconds(Clock::now() - start_time).count());
+    return std::none_of(results.begin(), results.end(), [](auto& r)
+    {
+        return r.status == BakeResult::Status::FAILED;
+    });
+}
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        auto args = parse_arguments(argc, argv);
+        auto trace_file = args.value("--trace").as_string();
+        if (!trace_file.empty())
+            trace::enable();
+
+        if (auto manifest = args.value("--manifest"))
+        {
+            if (args.value("FONT"))
+                args.error("FONT, SIZE and OUTPUT can't be combined with --manifest.");
+            auto ok = run_manifest(manifest.as_string(),
+                                   args.value("--threads").as_uint(0),
+                                   args.value("--force").as_bool());
+            if (!trace_file.empty())
+                trace::write(trace_file);
+            return ok ? 0 : 1;
+        }
+
+        if (!args.value("OUTPUT"))
+            args.error("FONT, SIZE and OUTPUT are required without --manifest.");
+
+        auto chars = get_chars(args);
+        auto font = make_bitmap_font(args.value("FONT").as_string(),
+                                     args.value("SIZE").as_uint(),
+                                     chars);
+        write_outputs(font, {args.value("OUTPUT").as_string()},
+                      args.value("--name").as_string("DefaultFont"));
+
+        if (!trace_file.empty())
+            trace::write(trace_file);
+    }
+    catch (std::exception& ex)
+    {
+        std::cout << ex.what() << "\n";
+        return 1;
+    }
+    return 0;
+}